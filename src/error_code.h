@@ -18,10 +18,16 @@ enum ErrorCode {
     Add_Epoll_Event_Failed,
     Delete_Epoll_Event_Failed,
     Modify_Epoll_Event_Failed,
+    Invalid_Cpu_Set,
+    Poll_Thread_Released,
 
     // Utils Errors
     Utils_Error_Start = 0x000F0101,
     Buffer_Not_Enough_Capacity,
+    File_Open_Failed,
+    File_Map_Failed,
+    File_Too_Large,
+    Buffer_Read_Only,
 };
 
 #endif //ERROR_CODE_H
@@ -0,0 +1,83 @@
+#include "endpoint.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+
+Endpoint::Endpoint() = default;
+
+Endpoint::Endpoint(const sockaddr *addr, socklen_t addr_len) {
+    if (addr && addr_len > 0 && addr_len <= sizeof(addr_)) {
+        memcpy(&addr_, addr, addr_len);
+        addr_len_ = addr_len;
+    }
+}
+
+bool Endpoint::Parse(const std::string &ip, uint16_t port, Endpoint &endpoint) {
+    Endpoint result;
+
+    auto addr4 = reinterpret_cast<sockaddr_in *>(&result.addr_);
+    if (inet_pton(AF_INET, ip.c_str(), &addr4->sin_addr) == 1) {
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(port);
+        result.addr_len_ = sizeof(sockaddr_in);
+        endpoint = result;
+        return true;
+    }
+
+    auto addr6 = reinterpret_cast<sockaddr_in6 *>(&result.addr_);
+    if (inet_pton(AF_INET6, ip.c_str(), &addr6->sin6_addr) == 1) {
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(port);
+        result.addr_len_ = sizeof(sockaddr_in6);
+        endpoint = result;
+        return true;
+    }
+
+    return false;
+}
+
+bool Endpoint::IsValid() const {
+    return addr_len_ > 0;
+}
+
+int Endpoint::GetFamily() const {
+    return addr_.ss_family;
+}
+
+sockaddr *Endpoint::GetAddress() const {
+    return (sockaddr *) &addr_;
+}
+
+socklen_t Endpoint::GetAddressLength() const {
+    return addr_len_;
+}
+
+std::string Endpoint::GetIp() const {
+    char ip[INET6_ADDRSTRLEN] = {0};
+    if (addr_.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in *>(&addr_)->sin_addr, ip, sizeof(ip));
+    } else if (addr_.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6 *>(&addr_)->sin6_addr, ip, sizeof(ip));
+    }
+
+    return ip;
+}
+
+uint16_t Endpoint::GetPort() const {
+    if (addr_.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<const sockaddr_in *>(&addr_)->sin_port);
+    } else if (addr_.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6 *>(&addr_)->sin6_port);
+    }
+
+    return 0;
+}
+
+std::string Endpoint::ToString() const {
+    if (addr_.ss_family == AF_INET6) {
+        return "[" + GetIp() + "]:" + std::to_string(GetPort());
+    }
+
+    return GetIp() + ":" + std::to_string(GetPort());
+}
@@ -0,0 +1,50 @@
+#ifndef ENDPOINT_H
+#define ENDPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+
+/**
+ * 解析好的socket地址，支持ipv4和ipv6
+ * 发送时直接使用，不需要每次解析ip字符串，可以缓存后重复使用
+ */
+class Endpoint {
+public:
+    explicit Endpoint();
+
+    explicit Endpoint(const sockaddr *addr, socklen_t addr_len);
+
+public:
+    /**
+     * 解析ip地址，不做域名解析
+     * @param ip ipv4或ipv6地址
+     * @param port 端口
+     * @param endpoint 解析结果
+     * @return 是否成功
+     */
+    static bool Parse(const std::string &ip, uint16_t port, Endpoint &endpoint);
+
+    bool IsValid() const;
+
+    int GetFamily() const;
+
+    sockaddr *GetAddress() const;
+
+    socklen_t GetAddressLength() const;
+
+    std::string GetIp() const;
+
+    uint16_t GetPort() const;
+
+    /**
+     * 例如 "127.0.0.1:80" 或 "[::1]:80"
+     */
+    std::string ToString() const;
+
+private:
+    sockaddr_storage addr_{};
+    socklen_t addr_len_ = 0;
+};
+
+#endif //ENDPOINT_H
@@ -1,18 +1,34 @@
 #include "poll_thread.h"
 
+#include <algorithm>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include "spdlog/spdlog.h"
+#include "utils/buffer_pool.h"
+#include "utils/clock.h"
+#include "utils/cpu_topology.h"
 
 static constexpr int kMaxEpollEventCount = 64;
 static constexpr int kSharedReadBufferSize = 1024 * 1024;
+static constexpr int kEpollWaitTimeoutMs = 1000;
+
+static thread_local PollThread *current_poll_thread = nullptr;
 
 PollThread::PollThread(int id)
         : id_(id) {
 }
 
+PollThread::PollThread(int id, PollThreadOptions options)
+        : id_(id), options_(std::move(options)) {
+}
+
 PollThread::~PollThread() {
     Release();
+    Cleanup();
 
     SPDLOG_INFO("poll thread {0} was de-constructed", id_);
 }
@@ -22,8 +38,29 @@ ErrorCode PollThread::Initialize() {
         return Already_Initialized;
     }
 
-    events_ = new epoll_event[kMaxEpollEventCount];
-    shared_read_buffer_ = std::make_shared<MutableBuffer>(kSharedReadBufferSize);
+    auto error_code = ValidateCpus();
+    if (error_code != Success) {
+        return error_code;
+    }
+
+    numa_node_ = options_.numa_node;
+    if (numa_node_ < 0 && !options_.cpus.empty() && CpuTopology::GetNumaNodeCount() > 1) {
+        numa_node_ = CpuTopology::GetNumaNodeOfCpus(options_.cpus);
+    }
+
+    if (numa_node_ >= 0 || options_.read_buffer_huge_pages != HugePageMode::None ||
+        options_.read_buffer_prefault || options_.read_buffer_lock) {
+        // the pages of the shared read buffer were bound to the node of the poll thread
+        PageAllocatorOptions allocator_options;
+        allocator_options.numa_node = numa_node_;
+        allocator_options.huge_pages = options_.read_buffer_huge_pages;
+        allocator_options.prefault = options_.read_buffer_prefault;
+        allocator_options.lock = options_.read_buffer_lock;
+        auto allocator = std::make_shared<PageAllocator>(allocator_options);
+        shared_read_buffer_ = std::make_shared<MutableBuffer>(kSharedReadBufferSize, allocator);
+    } else {
+        shared_read_buffer_ = std::make_shared<MutableBuffer>(kSharedReadBufferSize);
+    }
 
     int epoll_fd = epoll_create1(0);
     if (epoll_fd < 0) {
@@ -32,36 +69,129 @@ ErrorCode PollThread::Initialize() {
         return Create_Epoll_Failed;
     }
 
+    int wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd < 0) {
+        SPDLOG_ERROR("poll thread {0} create eventfd failed with error {1}, reason: '{2}'",
+                     id_, errno, strerror(errno));
+        close(epoll_fd);
+        return Create_Epoll_Failed;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev)) {
+        SPDLOG_ERROR("poll thread {0} add wakeup event failed with error {1}, reason: '{2}'",
+                     id_, errno, strerror(errno));
+        close(wakeup_fd);
+        close(epoll_fd);
+        return Add_Epoll_Event_Failed;
+    }
+
     epoll_fd_ = epoll_fd;
-    work_thread_ = std::thread([this]() {
-        RunLoop();
+    wakeup_fd_ = wakeup_fd;
+    auto weak_self = weak_from_this();
+    work_thread_ = std::thread([this, weak_self]() {
+        RunLoop(weak_self);
     });
 
     return Success;
 }
 
 void PollThread::Release() {
+    {
+        // later AddEvent/ModifyEvent/Async calls fail instead of touching the closed fds
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (released_) {
+            return;
+        }
+        released_ = true;
+    }
+
     stop_flag_ = true;
     if (work_thread_.joinable()) {
+        if (IsCurrentThread()) {
+            // released by its own callback, e.g. the last holder was dropped there,
+            // the loop cleans up after the callback returned
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                detached_ = true;
+            }
+            work_thread_.detach();
+            return;
+        }
+
+        Wakeup();
         work_thread_.join();
     }
 
-    if (epoll_fd_) {
+    Cleanup();
+}
+
+void PollThread::Cleanup() {
+    std::map<int, PendingEvent> pending_event_map;
+    std::vector<PollTask> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (epoll_fd_ == 0) {
+            return;
+        }
+
+        if (wakeup_fd_ >= 0) {
+            close(wakeup_fd_);
+            wakeup_fd_ = -1;
+        }
+
         close(epoll_fd_);
         epoll_fd_ = 0;
+
+        event_map_.clear();
+        event_count_ = 0;
+        pending_event_map.swap(pending_event_map_);
+        tasks.swap(pending_tasks_);
+        shared_read_buffer_.reset();
+        delete[] events_;
+        events_ = nullptr;
+    }
+
+    // accepted before the release, so they are not dropped silently
+    for (auto &it: pending_event_map) {
+        for (auto &cb: it.second.callbacks) {
+            try {
+                cb(false);
+            } catch (std::exception &ex) {
+                SPDLOG_ERROR("poll thread {0} modify event callback raise exception '{1}'", id_, ex.what());
+            }
+        }
     }
 
-    event_map_.clear();
-    shared_read_buffer_.reset();
-    delete[] events_;
-    events_ = nullptr;
+    for (auto &task: tasks) {
+        try {
+            task();
+        } catch (std::exception &ex) {
+            SPDLOG_ERROR("poll thread {0} task raise exception '{1}'", id_, ex.what());
+        }
+    }
 
     SPDLOG_INFO("poll thread {0} was released", id_);
 }
 
-ErrorCode PollThread::AddEvent(int fd, int events, PollEventCallback callback) {
+int PollThread::GetId() const {
+    return id_;
+}
+
+int PollThread::GetNumaNode() const {
+    return numa_node_;
+}
+
+ErrorCode PollThread::AddEvent(int fd, int events, PollEventCallback callback, PollMigrateCallback migrate_callback) {
     std::unique_lock<std::mutex> lock(mutex_);
 
+    if (released_) {
+        SPDLOG_ERROR("poll thread {0} was released, can not add event of fd {1}", id_, fd);
+        return Poll_Thread_Released;
+    }
+
     epoll_event ev{};
     ev.events = ToPollEvents(events);
     ev.data.fd = fd;
@@ -72,7 +202,14 @@ ErrorCode PollThread::AddEvent(int fd, int events, PollEventCallback callback) {
         return Add_Epoll_Event_Failed;
     }
 
-    event_map_[fd] = std::make_shared<PollEventCallback>(std::move(callback));
+    if (event_map_.find(fd) == event_map_.end()) {
+        ++event_count_;
+    }
+
+    auto &entry = event_map_[fd];
+    entry.events = events;
+    entry.callback = std::make_shared<PollEventCallback>(std::move(callback));
+    entry.migrate_callback = std::move(migrate_callback);
 
     return Success;
 }
@@ -80,6 +217,15 @@ ErrorCode PollThread::AddEvent(int fd, int events, PollEventCallback callback) {
 ErrorCode PollThread::DelEvent(int fd, const PollCompleteCallback &callback) {
     std::unique_lock<std::mutex> lock(mutex_);
 
+    if (released_) {
+        // the epoll fd was closed together with all its events
+        lock.unlock();
+        if (callback) {
+            callback(false);
+        }
+        return Poll_Thread_Released;
+    }
+
     ErrorCode ret = Success;
 
     epoll_event ev{};
@@ -92,7 +238,10 @@ ErrorCode PollThread::DelEvent(int fd, const PollCompleteCallback &callback) {
         ret = Delete_Epoll_Event_Failed;
     }
 
-    event_map_.erase(fd);
+    if (event_map_.erase(fd)) {
+        --event_count_;
+    }
+    pending_event_map_.erase(fd);
 
     if (callback) {
         try {
@@ -106,23 +255,63 @@ ErrorCode PollThread::DelEvent(int fd, const PollCompleteCallback &callback) {
 }
 
 ErrorCode PollThread::ModifyEvent(int fd, int events, const PollCompleteCallback &callback) {
+    return ChangeEvent(fd, events, nullptr, callback);
+}
+
+ErrorCode PollThread::RefreshEvent(int fd, PollEventsCallback events_callback, const PollCompleteCallback &callback) {
+    return ChangeEvent(fd, 0, std::move(events_callback), callback);
+}
+
+ErrorCode PollThread::ChangeEvent(int fd, int events, PollEventsCallback events_callback,
+                                  const PollCompleteCallback &callback) {
     std::unique_lock<std::mutex> lock(mutex_);
 
-    ErrorCode ret = Success;
+    if (released_) {
+        SPDLOG_ERROR("poll thread {0} was released, can not modify event of fd {1}", id_, fd);
+        return Poll_Thread_Released;
+    }
 
-    epoll_event ev{};
-    ev.events = ToPollEvents(events);
-    ev.data.fd = fd;
-    int rc = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
-    if (rc) {
-        SPDLOG_ERROR("poll thread {0} epoll_ctl modify event failed with error: {1}, reason: '{2}'",
-                     id_, errno, strerror(errno));
-        ret = Modify_Epoll_Event_Failed;
+    if (!IsCurrentThread()) {
+        // defer to the poll thread, only the latest request of the fd will be applied
+        auto &pending = pending_event_map_[fd];
+        pending.events = events;
+        pending.events_callback = std::move(events_callback);
+        if (callback) {
+            pending.callbacks.push_back(callback);
+        }
+
+        Wakeup();
+
+        return Success;
     }
 
+    std::vector<PollCompleteCallback> callbacks;
+    auto it = pending_event_map_.find(fd);
+    if (it != pending_event_map_.end()) {
+        // the current request was newer than the pending one
+        callbacks.swap(it->second.callbacks);
+        pending_event_map_.erase(it);
+    }
     if (callback) {
+        callbacks.push_back(callback);
+    }
+
+    ErrorCode ret;
+    if (events_callback) {
+        // called without the lock, it may drop the last reference of the owner which deletes the event
+        auto registration = GetRegistration(fd);
+        lock.unlock();
+        events = events_callback();
+        lock.lock();
+        ret = ApplyRefreshedEvent(fd, events, registration);
+    } else {
+        ret = ApplyEvent(fd, events);
+    }
+    lock.unlock();
+
+    for (auto &cb: callbacks) {
         try {
-            callback(rc == 0);
+            cb(ret == Success);
         } catch (std::exception &ex) {
             SPDLOG_ERROR("poll thread {0} modify event callback raise exception '{1}'", id_, ex.what());
         }
@@ -136,9 +325,127 @@ std::shared_ptr<MutableBuffer> PollThread::GetSharedReadBuffer() const {
     return shared_read_buffer_;
 }
 
-void PollThread::RunLoop() {
+bool PollThread::IsCurrentThread() const {
+    return current_poll_thread == this;
+}
+
+ErrorCode PollThread::Async(PollTask task, bool may_sync) {
+    if (may_sync && IsCurrentThread()) {
+        task();
+        return Success;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (released_) {
+        SPDLOG_ERROR("poll thread {0} was released, can not run task", id_);
+        return Poll_Thread_Released;
+    }
+
+    pending_tasks_.push_back(std::move(task));
+    Wakeup();
+
+    return Success;
+}
+
+int PollThread::GetSocketBusyPollMicroseconds() const {
+    return options_.socket_busy_poll_us;
+}
+
+bool PollThread::IsSocketPreferBusyPoll() const {
+    return options_.socket_prefer_busy_poll;
+}
+
+int64_t PollThread::GetBusyPollWindowMicroseconds() const {
+    return busy_poll_window_us_.load(std::memory_order_relaxed);
+}
+
+int64_t PollThread::GetBusyNanoseconds() const {
+    return busy_ns_;
+}
+
+int64_t PollThread::GetNow() const {
+    return now_ns_.load(std::memory_order_relaxed);
+}
+
+int64_t PollThread::Now() {
+    if (current_poll_thread) {
+        return current_poll_thread->GetNow();
+    }
+
+    return Clock::Now();
+}
+
+void PollThread::Drain(PollSelectCallback select_callback) {
+    draining_ = true;
+
+    auto weak_self = weak_from_this();
+    Async([weak_self, select_callback]() {
+        auto strong_self = weak_self.lock();
+        if (strong_self == nullptr) {
+            return;
+        }
+
+        std::vector<PollMigrateCallback> migrate_callbacks;
+        {
+            std::lock_guard<std::mutex> lock(strong_self->mutex_);
+            for (auto &it: strong_self->event_map_) {
+                if (it.second.migrate_callback) {
+                    migrate_callbacks.push_back(it.second.migrate_callback);
+                }
+            }
+        }
+
+        SPDLOG_INFO("poll thread {0} drain {1} of {2} events", strong_self->id_,
+                    migrate_callbacks.size(), strong_self->GetEventCount());
+
+        for (auto &migrate_callback: migrate_callbacks) {
+            auto target = select_callback();
+            if (target == nullptr || target == strong_self) {
+                continue;
+            }
+
+            try {
+                migrate_callback(target);
+            } catch (std::exception &ex) {
+                SPDLOG_ERROR("poll thread {0} migrate callback raise exception '{1}'", strong_self->id_, ex.what());
+            }
+        }
+    });
+}
+
+bool PollThread::IsDraining() const {
+    return draining_;
+}
+
+int PollThread::GetEventCount() const {
+    return event_count_;
+}
+
+void PollThread::UpdateQueuedBytes(int64_t delta) {
+    queued_bytes_ += delta;
+}
+
+int64_t PollThread::GetQueuedBytes() const {
+    return queued_bytes_;
+}
+
+void PollThread::RunLoop(const std::weak_ptr<PollThread> &weak_self) {
+    current_poll_thread = this;
+
+    ApplyThreadOptions();
+
+    // allocated by the poll thread, so it was placed by the memory policy of the thread
+    events_ = new epoll_event[kMaxEpollEventCount];
+    busy_poll_window_us_.store(options_.busy_poll_us, std::memory_order_relaxed);
+    scaled_average_idle_us_ = 0;
+    now_ns_.store(Clock::Now(), std::memory_order_relaxed);
+
+    std::shared_ptr<PollThread> strong_self;
     do {
-        int nfds = epoll_wait(epoll_fd_, events_, kMaxEpollEventCount, 1000);
+        int nfds = WaitEvents();
+        // intervals always use the precise monotonic clock, the selected source may be jiffy-granular
+        auto wakeup_ns = Clock::GetMonotonicNanoseconds();
+        now_ns_.store(Clock::Now(), std::memory_order_relaxed);
         if (nfds < 0) {
             SPDLOG_WARN("epoll wait failed with error: {0}, description: '{1}'", errno, strerror(errno));
             continue;
@@ -148,17 +455,38 @@ void PollThread::RunLoop() {
             break;
         }
 
+        if (nfds == 0) {
+            // idle for a whole wait timeout, hand the cached buffers back to the busy threads
+            BufferPool::GetInstance()->ReleaseThreadCache();
+        }
+
         SPDLOG_TRACE("epoll {0} thread return with {1} events", id_, nfds);
 
+        // the callbacks may drop the last holder, the thread is destroyed after them on this thread
+        strong_self = weak_self.lock();
+
+        ApplyPendingEvents();
+
         for (int n = 0; n < nfds; ++n) {
             auto fd = events_[n].data.fd;
-            auto it = event_map_.find(fd);
-            if (it == event_map_.end()) {
-                DelEvent(fd, nullptr);
+            if (fd == wakeup_fd_) {
+                OnWakeupEvent();
+                continue;
+            }
+
+            std::shared_ptr<PollEventCallback> callback;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = event_map_.find(fd);
+                if (it != event_map_.end()) {
+                    callback = it->second.callback;
+                }
+            }
+            if (callback == nullptr) {
+                // deleted or migrated by an earlier callback or task of this batch
                 continue;
             }
 
-            auto callback = it->second;
             auto events = events_[n].events;
             SPDLOG_DEBUG("epoll {0} thread received event by index {1} was 0x{2:08X}", id_, n, events);
 
@@ -168,7 +496,307 @@ void PollThread::RunLoop() {
                 SPDLOG_ERROR("epoll {0} thread event callback raise exception '{1}'", id_, ex.what());
             }
         }
+
+        busy_ns_ += Clock::GetMonotonicNanoseconds() - wakeup_ns;
+
+        if (stop_flag_) {
+            // still held, so a release by a callback cleans up before the thread may be destroyed
+            break;
+        }
+
+        if (strong_self) {
+            strong_self.reset();
+            if (weak_self.expired()) {
+                // destroyed, or being destroyed by the joining thread, the members must not be touched
+                current_poll_thread = nullptr;
+                return;
+            }
+        }
     } while (!stop_flag_);
+
+    OnLoopExit();
+
+    current_poll_thread = nullptr;
+}
+
+void PollThread::OnLoopExit() {
+    // tasks accepted before the release still run on the poll thread
+    RunPendingTasks();
+
+    bool detached;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        detached = detached_;
+    }
+    if (detached) {
+        // released by a callback, nobody joins to clean up
+        Cleanup();
+    }
+}
+
+int PollThread::WaitEvents() {
+    int nfds = 0;
+    if (options_.busy_poll_us <= 0) {
+        do {
+            nfds = epoll_wait(epoll_fd_, events_, kMaxEpollEventCount, kEpollWaitTimeoutMs);
+        } while (nfds < 0 && errno == EINTR && !stop_flag_);
+
+        return nfds;
+    }
+
+    auto start_ns = Clock::GetMonotonicNanoseconds();
+    int64_t idle_us = 0;
+
+    while (idle_us < busy_poll_window_us_.load(std::memory_order_relaxed) && !stop_flag_) {
+        nfds = epoll_wait(epoll_fd_, events_, kMaxEpollEventCount, 0);
+        idle_us = (Clock::GetMonotonicNanoseconds() - start_ns) / 1000;
+        if (nfds > 0) {
+            UpdateBusyPollWindow(idle_us);
+            return nfds;
+        }
+
+        // a signal only interrupts the spin, other errors are reported by the caller
+        if (nfds < 0 && errno != EINTR) {
+            return nfds;
+        }
+    }
+
+    do {
+        nfds = epoll_wait(epoll_fd_, events_, kMaxEpollEventCount, kEpollWaitTimeoutMs);
+    } while (nfds < 0 && errno == EINTR && !stop_flag_);
+    idle_us = (Clock::GetMonotonicNanoseconds() - start_ns) / 1000;
+    if (nfds > 0) {
+        UpdateBusyPollWindow(idle_us);
+    }
+
+    return nfds;
+}
+
+void PollThread::UpdateBusyPollWindow(int64_t idle_us) {
+    if (!options_.adaptive_busy_poll) {
+        return;
+    }
+
+    // moving average of the idle time between two wakeups, weight 1/8 for the new sample
+    // kept as 8 times the average, so differences below 8us are not truncated away
+    scaled_average_idle_us_ += idle_us - (scaled_average_idle_us_ >> 3);
+    auto average_idle_us = scaled_average_idle_us_ >> 3;
+
+    // spin about twice the usual idle time, stop spinning if events usually come later than the limit
+    auto window_us = 2 * average_idle_us + 1;
+    busy_poll_window_us_.store(window_us <= options_.busy_poll_us ? window_us : 0, std::memory_order_relaxed);
+}
+
+ErrorCode PollThread::ValidateCpus() const {
+    if (options_.cpus.empty()) {
+        return Success;
+    }
+
+    auto available_cpus = CpuTopology::GetAvailableCpus();
+    for (auto cpu: options_.cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            SPDLOG_ERROR("poll thread {0} cpu {1} was out of range [0, {2})", id_, cpu, CPU_SETSIZE);
+            return Invalid_Cpu_Set;
+        }
+
+        if (std::find(available_cpus.begin(), available_cpus.end(), cpu) == available_cpus.end()) {
+            SPDLOG_ERROR("poll thread {0} cpu {1} was not available to the process", id_, cpu);
+            return Invalid_Cpu_Set;
+        }
+    }
+
+    return Success;
+}
+
+void PollThread::ApplyThreadOptions() {
+    if (!options_.name.empty()) {
+        auto name = options_.name.substr(0, 15);
+        int rc = pthread_setname_np(pthread_self(), name.c_str());
+        if (rc) {
+            SPDLOG_WARN("poll thread {0} set name '{1}' failed with error: {2}", id_, name, rc);
+        }
+    }
+
+    if (!options_.cpus.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        std::string cpus;
+        for (auto cpu: options_.cpus) {
+            CPU_SET(cpu, &cpu_set);
+            cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+        }
+
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (rc) {
+            SPDLOG_WARN("poll thread {0} set cpu affinity failed with error: {1}, reason: '{2}'",
+                        id_, rc, strerror(rc));
+        } else {
+            SPDLOG_INFO("poll thread {0} was bound to cpu {1}", id_, cpus);
+        }
+    }
+
+    if (numa_node_ >= 0) {
+        // allocations made by the poll thread prefer the local node
+        if (!PageAllocator::SetPreferredNumaNode(numa_node_)) {
+            SPDLOG_WARN("poll thread {0} set preferred numa node {1} failed with error: {2}, reason: '{3}'",
+                        id_, numa_node_, errno, strerror(errno));
+        }
+    }
+
+    if (options_.sched_policy != SCHED_OTHER) {
+        sched_param param{};
+        param.sched_priority = options_.sched_priority;
+        int rc = pthread_setschedparam(pthread_self(), options_.sched_policy, &param);
+        if (rc) {
+            SPDLOG_WARN("poll thread {0} set sched policy {1} priority {2} failed with error: {3}, reason: '{4}'",
+                        id_, options_.sched_policy, options_.sched_priority, rc, strerror(rc));
+        }
+    } else if (options_.nice != 0) {
+        auto tid = static_cast<id_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, tid, options_.nice)) {
+            SPDLOG_WARN("poll thread {0} set nice {1} failed with error: {2}, reason: '{3}'",
+                        id_, options_.nice, errno, strerror(errno));
+        }
+    }
+}
+
+ErrorCode PollThread::ApplyEvent(int fd, int events) {
+    auto it = event_map_.find(fd);
+    if (it == event_map_.end()) {
+        SPDLOG_WARN("poll thread {0} modify event of unregistered fd {1}", id_, fd);
+        return Modify_Epoll_Event_Failed;
+    }
+
+    if (it->second.events == events) {
+        return Success;
+    }
+
+    epoll_event ev{};
+    ev.events = ToPollEvents(events);
+    ev.data.fd = fd;
+    int rc = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    if (rc) {
+        SPDLOG_ERROR("poll thread {0} epoll_ctl modify event failed with error: {1}, reason: '{2}'",
+                     id_, errno, strerror(errno));
+        return Modify_Epoll_Event_Failed;
+    }
+
+    it->second.events = events;
+
+    return Success;
+}
+
+std::shared_ptr<PollThread::PollEventCallback> PollThread::GetRegistration(int fd) const {
+    auto it = event_map_.find(fd);
+    if (it == event_map_.end()) {
+        return nullptr;
+    }
+
+    return it->second.callback;
+}
+
+ErrorCode PollThread::ApplyRefreshedEvent(int fd, int events, const std::shared_ptr<PollEventCallback> &registration) {
+    if (released_) {
+        return Poll_Thread_Released;
+    }
+
+    // the owner deleted the event while its events were computed, the fd may even be registered again
+    if (registration == nullptr || GetRegistration(fd) != registration) {
+        return Modify_Epoll_Event_Failed;
+    }
+
+    return ApplyEvent(fd, events);
+}
+
+void PollThread::ApplyPendingEvents() {
+    std::map<int, PendingEvent> pending_event_map;
+    std::map<int, std::shared_ptr<PollEventCallback>> registrations;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_event_map_.empty()) {
+            return;
+        }
+
+        pending_event_map.swap(pending_event_map_);
+        for (auto &it: pending_event_map) {
+            if (it.second.events_callback) {
+                registrations[it.first] = GetRegistration(it.first);
+            }
+        }
+    }
+
+    // called without the lock, they may drop the last reference of the owner which deletes the event
+    for (auto &it: pending_event_map) {
+        auto &pending = it.second;
+        if (pending.events_callback && registrations[it.first]) {
+            pending.events = pending.events_callback();
+        }
+    }
+
+    std::vector<std::pair<PollCompleteCallback, bool>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &it: pending_event_map) {
+            auto &pending = it.second;
+            ErrorCode error_code;
+            if (pending.events_callback) {
+                error_code = ApplyRefreshedEvent(it.first, pending.events, registrations[it.first]);
+            } else {
+                error_code = released_ ? Poll_Thread_Released : ApplyEvent(it.first, pending.events);
+            }
+
+            for (auto &cb: pending.callbacks) {
+                callbacks.emplace_back(std::move(cb), error_code == Success);
+            }
+        }
+    }
+
+    for (auto &it: callbacks) {
+        try {
+            it.first(it.second);
+        } catch (std::exception &ex) {
+            SPDLOG_ERROR("poll thread {0} modify event callback raise exception '{1}'", id_, ex.what());
+        }
+    }
+}
+
+void PollThread::RunPendingTasks() {
+    std::vector<PollTask> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks.swap(pending_tasks_);
+    }
+
+    for (auto &task: tasks) {
+        try {
+            task();
+        } catch (std::exception &ex) {
+            SPDLOG_ERROR("poll thread {0} task raise exception '{1}'", id_, ex.what());
+        }
+    }
+}
+
+void PollThread::Wakeup() {
+    if (wakeup_fd_ < 0 || wakeup_pending_.exchange(true)) {
+        return;
+    }
+
+    uint64_t value = 1;
+    if (write(wakeup_fd_, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        SPDLOG_WARN("poll thread {0} write wakeup event failed with error: {1}, reason: '{2}'",
+                    id_, errno, strerror(errno));
+    }
+}
+
+void PollThread::OnWakeupEvent() {
+    wakeup_pending_ = false;
+
+    uint64_t value = 0;
+    while (read(wakeup_fd_, &value, sizeof(value)) > 0) {
+    }
+
+    ApplyPendingEvents();
+    RunPendingTasks();
 }
 
 uint32_t PollThread::ToPollEvents(int events) {
@@ -6,10 +6,14 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <sched.h>
+#include <string>
 #include <sys/epoll.h>
 #include <thread>
+#include <vector>
 
 #include "error_code.h"
+#include "utils/memory_allocator.h"
 #include "utils/mutable_buffer.h"
 
 enum PollEvent {
@@ -19,19 +23,70 @@ enum PollEvent {
     Event_ET = 1 << 3,
 };
 
+struct PollThreadOptions {
+    // 线程名，最多15个字符，为空时不设置
+    std::string name;
+    // 绑定的cpu列表，为空时不绑定，包含超出范围或进程不可用的cpu时Initialize返回Invalid_Cpu_Set
+    std::vector<int> cpus;
+    // 调度策略，例如 SCHED_OTHER, SCHED_FIFO, SCHED_RR
+    int sched_policy = SCHED_OTHER;
+    // 实时调度策略的优先级
+    int sched_priority = 0;
+    // SCHED_OTHER 下的nice值
+    int nice = 0;
+    // 线程内存所在的numa节点，-1时按绑定的cpu自动选择
+    int numa_node = -1;
+    // 阻塞等待前使用非阻塞epoll_wait忙轮询的最长时间(微秒)，0时不忙轮询
+    int busy_poll_us = 0;
+    // 是否根据测量的空闲时间自适应调整忙轮询时间
+    bool adaptive_busy_poll = true;
+    // 对该线程上的socket设置SO_BUSY_POLL(微秒)，0时不设置
+    int socket_busy_poll_us = 0;
+    // 对该线程上的socket设置SO_PREFER_BUSY_POLL
+    bool socket_prefer_busy_poll = false;
+    // 共享读缓存的大页模式
+    HugePageMode read_buffer_huge_pages = HugePageMode::None;
+    // 共享读缓存在初始化时预先缺页
+    bool read_buffer_prefault = false;
+    // 共享读缓存mlock锁定
+    bool read_buffer_lock = false;
+};
+
 class PollThread : public std::enable_shared_from_this<PollThread> {
 public:
     explicit PollThread(int id);
 
+    explicit PollThread(int id, PollThreadOptions options);
+
     ~PollThread();
 
     using PollEventCallback = std::function<void(int event)>;
 
     using PollCompleteCallback = std::function<void(bool success)>;
 
+    using PollEventsCallback = std::function<int()>;
+
+    using PollTask = std::function<void()>;
+
+    using PollMigrateCallback = std::function<void(const std::shared_ptr<PollThread> &poll_thread)>;
+
+    using PollSelectCallback = std::function<std::shared_ptr<PollThread>()>;
+
 public:
     ErrorCode Initialize();
 
+    int GetId() const;
+
+    /**
+     * 获取poll线程所在的numa节点，未绑定到单个节点时返回-1
+     */
+    int GetNumaNode() const;
+
+    /**
+     * 停止poll线程并关闭epoll，之后的AddEvent/ModifyEvent/Async都返回Poll_Thread_Released
+     * 已经提交的Async任务仍会执行，未应用的修改回调失败
+     * 在poll线程的回调中调用时不等待线程退出，本轮回调结束后poll线程自行清理
+     */
     void Release();
 
     /**
@@ -39,9 +94,10 @@ public:
      * @param fd 监听的文件描述符
      * @param events 事件类型，例如 Event_Read | Event_Write
      * @param cb 事件回调functional
+     * @param migrate_cb 迁移回调，Drain时用于把fd迁移到其他poll线程，为空时该fd不能迁移
      * @return -1:失败，0:成功
      */
-    ErrorCode AddEvent(int fd, int events, PollEventCallback cb);
+    ErrorCode AddEvent(int fd, int events, PollEventCallback cb, PollMigrateCallback migrate_cb = nullptr);
 
     /**
      * 删除事件监听
@@ -53,16 +109,143 @@ public:
 
     /**
      * 修改监听事件类型
+     * 与当前已注册的事件类型相同时不会调用epoll_ctl
+     * 非poll线程调用时，修改会延迟到poll线程中执行，同一fd的多次修改只保留最后一次
      * @param fd 监听的文件描述符
      * @param events 事件类型，例如 Event_Read | Event_Write
      * @return -1:失败，0:成功
      */
     ErrorCode ModifyEvent(int fd, int events, const PollCompleteCallback &cb = nullptr);
 
+    /**
+     * 按fd当前的状态重新计算监听事件类型，events_cb在poll线程中应用修改时才调用
+     * 非poll线程调用时只记录需要重新计算，避免先计算的旧事件类型覆盖后来的修改
+     * @param fd 监听的文件描述符
+     * @param events_cb 返回当前应监听的事件类型
+     */
+    ErrorCode RefreshEvent(int fd, PollEventsCallback events_cb, const PollCompleteCallback &cb = nullptr);
+
     std::shared_ptr<MutableBuffer> GetSharedReadBuffer() const;
 
+    /**
+     * 当前线程是否为poll线程
+     */
+    bool IsCurrentThread() const;
+
+    /**
+     * 在poll线程中执行任务
+     * @param task 任务
+     * @param may_sync 当前线程为poll线程时是否直接执行
+     * @return poll线程已经Release时返回Poll_Thread_Released，任务不会执行
+     */
+    ErrorCode Async(PollTask task, bool may_sync = true);
+
+    /**
+     * 获取监听的文件描述符个数
+     */
+    int GetEventCount() const;
+
+    /**
+     * 更新在该poll线程上等待发送的字节数，由Socket在入队、发送完成时调用
+     * @param delta 变化量
+     */
+    void UpdateQueuedBytes(int64_t delta);
+
+    /**
+     * 获取在该poll线程上等待发送的字节数
+     */
+    int64_t GetQueuedBytes() const;
+
+    /**
+     * 对socket设置SO_BUSY_POLL的时间(微秒)，0时不设置
+     */
+    int GetSocketBusyPollMicroseconds() const;
+
+    bool IsSocketPreferBusyPoll() const;
+
+    /**
+     * 获取当前阻塞等待前的忙轮询时间(微秒)，开启自适应时随事件间隔变化，不超过busy_poll_us
+     */
+    int64_t GetBusyPollWindowMicroseconds() const;
+
+    /**
+     * 获取poll线程处理事件(非等待)的累计时间，单位纳秒
+     */
+    int64_t GetBusyNanoseconds() const;
+
+    /**
+     * 获取本轮事件循环唤醒时缓存的时间，单位纳秒(Clock::Now的时间基准)，读取不产生系统调用
+     */
+    int64_t GetNow() const;
+
+    /**
+     * 在poll线程中返回该线程缓存的时间，否则返回Clock::Now()
+     */
+    static int64_t Now();
+
+    /**
+     * 把所有可迁移的fd迁移到其他poll线程，在poll线程中执行
+     * 可以重复调用，迁移Drain之后才注册的fd
+     * @param select_cb 为每个fd选择目标poll线程
+     */
+    void Drain(PollSelectCallback select_cb);
+
+    /**
+     * 是否已经调用过Drain，正在排空的poll线程不应再用于新的socket
+     */
+    bool IsDraining() const;
+
 private:
-    void RunLoop();
+    struct EventEntry {
+        int events = 0;
+        std::shared_ptr<PollEventCallback> callback;
+        PollMigrateCallback migrate_callback;
+    };
+
+    struct PendingEvent {
+        int events = 0;
+        // 不为空时在应用修改时计算事件类型
+        PollEventsCallback events_callback;
+        std::vector<PollCompleteCallback> callbacks;
+    };
+
+    void RunLoop(const std::weak_ptr<PollThread> &weak_self);
+
+    /**
+     * 关闭epoll并清理事件，执行剩余的任务，可以重复调用
+     */
+    void Cleanup();
+
+    void OnLoopExit();
+
+    int WaitEvents();
+
+    void UpdateBusyPollWindow(int64_t idle_us);
+
+    ErrorCode ValidateCpus() const;
+
+    void ApplyThreadOptions();
+
+    ErrorCode ChangeEvent(int fd, int events, PollEventsCallback events_callback,
+                          const PollCompleteCallback &callback);
+
+    ErrorCode ApplyEvent(int fd, int events);
+
+    std::shared_ptr<PollEventCallback> GetRegistration(int fd) const;
+
+    /**
+     * 应用RefreshEvent在锁外计算的事件类型，计算期间fd被删除或重新注册时不修改
+     * @param registration 计算前fd注册的事件回调
+     */
+    ErrorCode ApplyRefreshedEvent(int fd, int events, const std::shared_ptr<PollEventCallback> &registration);
+
+    void ApplyPendingEvents();
+
+    void RunPendingTasks();
+
+    void Wakeup();
+
+    void OnWakeupEvent();
 
     static uint32_t ToPollEvents(int events);
 
@@ -70,11 +253,27 @@ private:
 
 private:
     int id_ = 0;
+    PollThreadOptions options_;
+    int numa_node_ = -1;
+    std::atomic<int64_t> busy_poll_window_us_{0};
+    // 平均空闲时间的8倍(定点数)
+    int64_t scaled_average_idle_us_ = 0;
     std::mutex mutex_;
     int epoll_fd_ = 0;
     epoll_event *events_ = nullptr;
-    bool stop_flag_ = false;
-    std::map<int, std::shared_ptr<PollEventCallback>> event_map_;
+    std::atomic<bool> stop_flag_{false};
+    std::atomic<bool> draining_{false};
+    bool released_ = false;
+    bool detached_ = false;
+    std::map<int, EventEntry> event_map_;
+    std::map<int, PendingEvent> pending_event_map_;
+    std::vector<PollTask> pending_tasks_;
+    int wakeup_fd_ = -1;
+    std::atomic<bool> wakeup_pending_{false};
+    std::atomic<int> event_count_{0};
+    std::atomic<int64_t> queued_bytes_{0};
+    std::atomic<int64_t> busy_ns_{0};
+    std::atomic<int64_t> now_ns_{0};
     std::shared_ptr<MutableBuffer> shared_read_buffer_ = nullptr;
     std::thread work_thread_;
 };
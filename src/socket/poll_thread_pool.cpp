@@ -1,24 +1,43 @@
 #include "poll_thread_pool.h"
 
+#include <algorithm>
+#include <functional>
+#include <random>
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+#include "utils/cpu_topology.h"
+#include "socket.h"
+
+constexpr const char *PollThreadPool::kDefaultGroupName;
+
 static PollThreadPool *instance_ = nullptr;
+static std::mutex group_mutex_;
+static std::map<std::string, PollThreadPool::Ptr> group_map_;
 
-PollThreadPool::PollThreadPool() = default;
+PollThreadPool::PollThreadPool(std::string name)
+        : name_(std::move(name)) {
+}
 
-PollThreadPool::~PollThreadPool() = default;
+PollThreadPool::~PollThreadPool() {
+    Stop();
+}
 
 ErrorCode PollThreadPool::Initialize(int pool_size) {
-    instance_ = new PollThreadPool();
+    PollThreadPoolConfig config;
+    config.pool_size = pool_size;
 
-    if (pool_size < 0) {
-        pool_size = static_cast<int>(std::thread::hardware_concurrency());
-    }
+    return Initialize(config);
+}
 
-    for (int i = 0; i < pool_size; ++i) {
-        auto poll_thread = std::make_shared<PollThread>(i);
-        poll_thread->Initialize();
-        instance_->pool_.push_back(poll_thread);
+ErrorCode PollThreadPool::Initialize(const PollThreadPoolConfig &config) {
+    auto error_code = CreateGroup(kDefaultGroupName, config);
+    if (error_code != Success) {
+        return error_code;
     }
 
+    instance_ = GetGroup(kDefaultGroupName).get();
+
     return Success;
 }
 
@@ -26,7 +45,470 @@ PollThreadPool *PollThreadPool::GetInstance() {
     return instance_;
 }
 
+ErrorCode PollThreadPool::CreateGroup(const std::string &name, const PollThreadPoolConfig &config) {
+    std::lock_guard<std::mutex> lock(group_mutex_);
+    if (group_map_.find(name) != group_map_.end()) {
+        return Already_Initialized;
+    }
+
+    Ptr pool(new PollThreadPool(name));
+    auto error_code = pool->Start(config);
+    if (error_code != Success) {
+        SPDLOG_ERROR("poll thread pool {} start failed with error 0x{:08X}", name, int(error_code));
+        return error_code;
+    }
+
+    group_map_[name] = pool;
+
+    return Success;
+}
+
+PollThreadPool::Ptr PollThreadPool::GetGroup(const std::string &name) {
+    std::lock_guard<std::mutex> lock(group_mutex_);
+    auto it = group_map_.find(name);
+    if (it == group_map_.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+void PollThreadPool::ReleaseGroup(const std::string &name) {
+    Ptr pool;
+    {
+        std::lock_guard<std::mutex> lock(group_mutex_);
+        auto it = group_map_.find(name);
+        if (it == group_map_.end()) {
+            return;
+        }
+
+        pool = it->second;
+        group_map_.erase(it);
+        if (pool.get() == instance_) {
+            instance_ = nullptr;
+        }
+    }
+
+    // stopped here, or by the last holder outside the lock
+    pool.reset();
+}
+
+void PollThreadPool::Release() {
+    std::map<std::string, Ptr> group_map;
+    {
+        std::lock_guard<std::mutex> lock(group_mutex_);
+        group_map.swap(group_map_);
+        instance_ = nullptr;
+    }
+
+    group_map.clear();
+}
+
+const std::string &PollThreadPool::GetName() const {
+    return name_;
+}
+
+ErrorCode PollThreadPool::Start(const PollThreadPoolConfig &config) {
+    config_ = config;
+
+    int pool_size = config_.pool_size;
+    cpu_sets_ = GetCpuSets(config_, pool_size);
+
+    bool elastic = config_.max_pool_size > 0;
+    if (elastic) {
+        config_.min_pool_size = std::max(1, std::min(config_.min_pool_size, config_.max_pool_size));
+        pool_size = config_.min_pool_size;
+    }
+
+    for (int i = 0; i < pool_size; ++i) {
+        auto error_code = AddPollThread();
+        if (error_code != Success) {
+            // e.g. Invalid_Cpu_Set, an incomplete group is not created
+            Stop();
+            return error_code;
+        }
+    }
+
+    if (elastic) {
+        monitor_thread_ = std::thread([this]() {
+            RunMonitor();
+        });
+    }
+
+    return Success;
+}
+
+void PollThreadPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex_);
+        stop_monitor_ = true;
+    }
+    monitor_condition_.notify_all();
+    if (monitor_thread_.joinable()) {
+        monitor_thread_.join();
+    }
+
+    std::vector<std::shared_ptr<PollThread>> poll_threads;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        poll_threads.swap(pool_);
+        poll_threads.insert(poll_threads.end(), draining_pool_.begin(), draining_pool_.end());
+        draining_pool_.clear();
+    }
+
+    for (auto &poll_thread: poll_threads) {
+        poll_thread->Release();
+    }
+}
+
+ErrorCode PollThreadPool::AddPollThread() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+
+    auto id = next_poll_thread_id_++;
+
+    PollThreadOptions options;
+    options.name = fmt::format("{}-{}", config_.name.empty() ? name_ : config_.name, id);
+    if (!cpu_sets_.empty()) {
+        options.cpus = cpu_sets_[id % cpu_sets_.size()];
+    }
+    options.sched_policy = config_.sched_policy;
+    options.sched_priority = config_.sched_priority;
+    options.nice = config_.nice;
+    options.busy_poll_us = config_.busy_poll_us;
+    options.adaptive_busy_poll = config_.adaptive_busy_poll;
+    options.socket_busy_poll_us = config_.socket_busy_poll_us;
+    options.socket_prefer_busy_poll = config_.socket_prefer_busy_poll;
+    options.read_buffer_huge_pages = config_.read_buffer_huge_pages;
+    options.read_buffer_prefault = config_.read_buffer_prefault;
+    options.read_buffer_lock = config_.read_buffer_lock;
+
+    auto poll_thread = std::make_shared<PollThread>(id, options);
+    auto error_code = poll_thread->Initialize();
+    if (error_code != Success) {
+        SPDLOG_ERROR("poll thread pool {} initialize poll thread {} failed with error 0x{:08X}",
+                     name_, id, int(error_code));
+        return error_code;
+    }
+
+    pool_.push_back(poll_thread);
+
+    return Success;
+}
+
+void PollThreadPool::RemovePollThread() {
+    std::shared_ptr<PollThread> poll_thread;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (pool_.size() <= 1) {
+            return;
+        }
+
+        size_t index = 0;
+        for (size_t i = 1; i < pool_.size(); ++i) {
+            if (IsLessLoaded(pool_[i], pool_[index])) {
+                index = i;
+            }
+        }
+
+        // no longer selected for new sockets
+        poll_thread = pool_[index];
+        pool_.erase(pool_.begin() + static_cast<long>(index));
+        draining_pool_.push_back(poll_thread);
+        busy_ns_map_.erase(poll_thread.get());
+    }
+
+    SPDLOG_INFO("poll thread pool {} drain poll thread {}", name_, poll_thread->GetId());
+
+    DrainPollThread(poll_thread);
+}
+
+void PollThreadPool::DrainPollThread(const std::shared_ptr<PollThread> &poll_thread) {
+    // the task may run after the pool was stopped
+    auto weak_self = weak_from_this();
+    poll_thread->Drain([weak_self]() -> std::shared_ptr<PollThread> {
+        auto strong_self = weak_self.lock();
+        if (strong_self == nullptr) {
+            return nullptr;
+        }
+
+        return strong_self->GetPollThread();
+    });
+}
+
+void PollThreadPool::ReleaseDrainedPollThreads() {
+    std::vector<std::shared_ptr<PollThread>> drained;
+    std::vector<std::shared_ptr<PollThread>> draining;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (auto it = draining_pool_.begin(); it != draining_pool_.end();) {
+            // sockets may still hold the thread after their fds moved away, they get Poll_Thread_Released
+            if ((*it)->GetEventCount() == 0) {
+                drained.push_back(*it);
+                it = draining_pool_.erase(it);
+            } else {
+                draining.push_back(*it);
+                ++it;
+            }
+        }
+    }
+
+    for (auto &poll_thread: drained) {
+        SPDLOG_INFO("poll thread pool {} stop drained poll thread {}", name_, poll_thread->GetId());
+        poll_thread->Release();
+    }
+
+    // fds registered by sockets which selected the thread just before it was drained
+    for (auto &poll_thread: draining) {
+        DrainPollThread(poll_thread);
+    }
+}
+
+void PollThreadPool::RunMonitor() {
+    auto interval = std::chrono::milliseconds(std::max(1, config_.scale_interval_ms));
+    auto last_time = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(monitor_mutex_);
+    while (!monitor_condition_.wait_for(lock, interval, [this]() { return stop_monitor_; })) {
+        lock.unlock();
+
+        auto now = std::chrono::steady_clock::now();
+        Scale(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_time).count());
+        last_time = now;
+
+        lock.lock();
+    }
+}
+
+void PollThreadPool::Scale(int64_t elapsed_ns) {
+    ReleaseDrainedPollThreads();
+
+    auto utilization = SampleUtilization(elapsed_ns);
+    utilization_ = utilization;
+
+    if (utilization > config_.scale_up_utilization) {
+        ++scale_up_count_;
+        scale_down_count_ = 0;
+    } else if (utilization < config_.scale_down_utilization) {
+        ++scale_down_count_;
+        scale_up_count_ = 0;
+    } else {
+        scale_up_count_ = 0;
+        scale_down_count_ = 0;
+    }
+
+    auto size = static_cast<int>(GetSize());
+    if (scale_up_count_ >= config_.scale_samples && size < config_.max_pool_size) {
+        SPDLOG_INFO("poll thread pool {} utilization {:.2f}, grow to {} poll threads", name_, utilization, size + 1);
+        AddPollThread();
+        scale_up_count_ = 0;
+    } else if (scale_down_count_ >= config_.scale_samples && size > config_.min_pool_size) {
+        SPDLOG_INFO("poll thread pool {} utilization {:.2f}, shrink to {} poll threads", name_, utilization, size - 1);
+        RemovePollThread();
+        scale_down_count_ = 0;
+    }
+}
+
+double PollThreadPool::SampleUtilization(int64_t elapsed_ns) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+
+    double total = 0;
+    int count = 0;
+    for (auto &poll_thread: pool_) {
+        auto busy_ns = poll_thread->GetBusyNanoseconds();
+        auto it = busy_ns_map_.find(poll_thread.get());
+        if (it != busy_ns_map_.end() && elapsed_ns > 0) {
+            total += std::min(1.0, double(busy_ns - it->second) / double(elapsed_ns));
+            ++count;
+        }
+        busy_ns_map_[poll_thread.get()] = busy_ns;
+    }
+
+    return count ? total / count : 0;
+}
+
+void PollThreadPool::SetSelectPolicy(PollThreadSelectPolicy policy) {
+    policy_ = policy;
+}
+
+PollThreadSelectPolicy PollThreadPool::GetSelectPolicy() const {
+    return policy_;
+}
+
 std::shared_ptr<PollThread> PollThreadPool::GetPollThread() {
-    auto index = ++index_ % pool_.size();
+    return GetPollThread(policy_);
+}
+
+std::shared_ptr<PollThread> PollThreadPool::GetPollThread(PollThreadSelectPolicy policy) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (pool_.empty()) {
+        return nullptr;
+    }
+
+    size_t index;
+    switch (policy) {
+        case PollThreadSelectPolicy::LeastConnections: {
+            index = SelectByLeastConnections();
+            break;
+        }
+        case PollThreadSelectPolicy::LeastQueuedBytes: {
+            index = SelectByLeastQueuedBytes();
+            break;
+        }
+        case PollThreadSelectPolicy::PowerOfTwoChoices: {
+            index = SelectByPowerOfTwoChoices();
+            break;
+        }
+        case PollThreadSelectPolicy::RoundRobin:
+        default: {
+            index = SelectByRoundRobin();
+            break;
+        }
+    }
+
     return pool_[index];
 }
+
+std::shared_ptr<PollThread> PollThreadPool::GetPollThread(const std::shared_ptr<Socket> &socket) {
+    if (socket) {
+        auto poll_thread = socket->GetPollThread();
+        if (poll_thread && !poll_thread->IsDraining()) {
+            return poll_thread;
+        }
+    }
+
+    return GetPollThread();
+}
+
+std::shared_ptr<PollThread> PollThreadPool::GetPollThreadByNumaNode(int numa_node) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        std::vector<size_t> candidates;
+        for (size_t i = 0; i < pool_.size(); ++i) {
+            if (pool_[i]->GetNumaNode() == numa_node) {
+                candidates.push_back(i);
+            }
+        }
+
+        if (!candidates.empty()) {
+            return pool_[candidates[index_++ % candidates.size()]];
+        }
+    }
+
+    return GetPollThread();
+}
+
+std::vector<int> PollThreadPool::GetNumaNodes() const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    std::vector<int> numa_nodes;
+    for (auto &poll_thread: pool_) {
+        numa_nodes.push_back(poll_thread->GetNumaNode());
+    }
+
+    return numa_nodes;
+}
+
+int PollThreadPool::GetNumaNodeCount() {
+    return CpuTopology::GetNumaNodeCount();
+}
+
+size_t PollThreadPool::GetSize() const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    return pool_.size();
+}
+
+double PollThreadPool::GetUtilization() const {
+    return utilization_;
+}
+
+size_t PollThreadPool::SelectByRoundRobin() {
+    return index_++ % pool_.size();
+}
+
+size_t PollThreadPool::SelectByLeastConnections() const {
+    size_t index = 0;
+    for (size_t i = 1; i < pool_.size(); ++i) {
+        if (pool_[i]->GetEventCount() < pool_[index]->GetEventCount()) {
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+size_t PollThreadPool::SelectByLeastQueuedBytes() const {
+    size_t index = 0;
+    for (size_t i = 1; i < pool_.size(); ++i) {
+        if (pool_[i]->GetQueuedBytes() < pool_[index]->GetQueuedBytes()) {
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+size_t PollThreadPool::SelectByPowerOfTwoChoices() {
+    auto size = pool_.size();
+    if (size == 1) {
+        return 0;
+    }
+
+    static thread_local std::minstd_rand random_engine(
+            static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+
+    auto first = random_engine() % size;
+    auto second = random_engine() % (size - 1);
+    if (second >= first) {
+        ++second;
+    }
+
+    return IsLessLoaded(pool_[second], pool_[first]) ? second : first;
+}
+
+std::vector<std::vector<int>> PollThreadPool::GetCpuSets(const PollThreadPoolConfig &config, int &pool_size) {
+    std::vector<std::vector<int>> cpu_sets;
+
+    if (!config.cpu_sets.empty()) {
+        for (auto &cpu_set: config.cpu_sets) {
+            auto cpus = CpuTopology::Exclude(cpu_set, config.reserved_cpus);
+            if (cpus.empty()) {
+                SPDLOG_WARN("poll thread pool cpu set only contains reserved cpus, ignore it");
+                continue;
+            }
+            cpu_sets.push_back(cpus);
+        }
+    } else if (config.pin_physical_cores) {
+        auto cpus = CpuTopology::Exclude(CpuTopology::GetAvailableCpus(), config.reserved_cpus);
+        for (auto cpu: CpuTopology::GetPhysicalCoreCpus(cpus)) {
+            cpu_sets.push_back({cpu});
+        }
+    } else if (!config.reserved_cpus.empty()) {
+        // not pinned, only keep away from the reserved cpus
+        auto cpus = CpuTopology::Exclude(CpuTopology::GetAvailableCpus(), config.reserved_cpus);
+        if (!cpus.empty()) {
+            cpu_sets.push_back(cpus);
+            if (pool_size < 0) {
+                pool_size = static_cast<int>(cpus.size());
+            }
+        }
+    }
+
+    if (pool_size < 0) {
+        if (!cpu_sets.empty()) {
+            pool_size = static_cast<int>(cpu_sets.size());
+        } else {
+            pool_size = static_cast<int>(std::thread::hardware_concurrency());
+        }
+    }
+
+    return cpu_sets;
+}
+
+bool PollThreadPool::IsLessLoaded(const std::shared_ptr<PollThread> &lhs, const std::shared_ptr<PollThread> &rhs) {
+    auto lhs_count = lhs->GetEventCount();
+    auto rhs_count = rhs->GetEventCount();
+    if (lhs_count != rhs_count) {
+        return lhs_count < rhs_count;
+    }
+
+    return lhs->GetQueuedBytes() < rhs->GetQueuedBytes();
+}
@@ -1,28 +1,211 @@
 #ifndef POLL_THREAD_POOL_H
 #define POLL_THREAD_POOL_H
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "poll_thread.h"
 
-class PollThreadPool {
+class Socket;
+
+enum class PollThreadSelectPolicy {
+    RoundRobin = 0,
+    LeastConnections,
+    LeastQueuedBytes,
+    PowerOfTwoChoices,
+};
+
+struct PollThreadPoolConfig {
+    // 线程数，-1时按可用cpu数(绑核时按绑定的cpu数)创建
+    int pool_size = -1;
+    // 线程名前缀，线程名为 "{name}-{index}"，为空时使用线程组名
+    std::string name;
+    // 每个线程绑定的cpu列表，按线程序号循环使用，优先于 pin_physical_cores
+    std::vector<std::vector<int>> cpu_sets;
+    // 每个物理核绑定一个线程，跳过超线程的兄弟cpu
+    bool pin_physical_cores = false;
+    // 保留的cpu，poll线程不会运行在这些cpu上
+    std::vector<int> reserved_cpus;
+    // 调度策略，例如 SCHED_OTHER, SCHED_FIFO
+    int sched_policy = SCHED_OTHER;
+    // 实时调度策略的优先级
+    int sched_priority = 0;
+    // SCHED_OTHER 下的nice值
+    int nice = 0;
+    // 忙轮询配置，参考PollThreadOptions
+    int busy_poll_us = 0;
+    bool adaptive_busy_poll = true;
+    int socket_busy_poll_us = 0;
+    bool socket_prefer_busy_poll = false;
+    // 共享读缓存的内存配置，参考PollThreadOptions
+    HugePageMode read_buffer_huge_pages = HugePageMode::None;
+    bool read_buffer_prefault = false;
+    bool read_buffer_lock = false;
+    // 弹性伸缩的最大线程数，大于0时开启弹性伸缩，初始线程数为min_pool_size，忽略pool_size
+    int max_pool_size = 0;
+    // 弹性伸缩的最小线程数
+    int min_pool_size = 1;
+    // 平均利用率连续高于该值时增加线程
+    double scale_up_utilization = 0.75;
+    // 平均利用率连续低于该值时回收线程
+    double scale_down_utilization = 0.25;
+    // 利用率采样间隔，单位毫秒
+    int scale_interval_ms = 1000;
+    // 连续满足条件的采样次数
+    int scale_samples = 3;
+};
+
+class PollThreadPool : public std::enable_shared_from_this<PollThreadPool> {
 public:
+    using Ptr = std::shared_ptr<PollThreadPool>;
+
     ~PollThreadPool();
 
 public:
+    static constexpr const char *kDefaultGroupName = "default";
+
+    /**
+     * 初始化默认线程组
+     */
     static ErrorCode Initialize(int pool_size = -1);
 
+    static ErrorCode Initialize(const PollThreadPoolConfig &config);
+
+    /**
+     * 获取默认线程组
+     */
     static PollThreadPool *GetInstance();
 
+    /**
+     * 创建命名的线程组，例如绑核的"latency"组和不绑核的"bulk"组，不同组的socket不会共用poll线程
+     * 任一poll线程初始化失败时停止已经启动的线程并返回该错误，例如Invalid_Cpu_Set
+     * @param name 线程组名
+     * @param config 线程组配置
+     */
+    static ErrorCode CreateGroup(const std::string &name, const PollThreadPoolConfig &config);
+
+    /**
+     * 获取命名的线程组，不存在时返回nullptr
+     * 需要长期使用线程组的对象(例如TcpServer)应持有返回的shared_ptr
+     * @param name 线程组名
+     */
+    static Ptr GetGroup(const std::string &name);
+
+    /**
+     * 释放命名的线程组，之后GetGroup不再返回它，仍被持有时在最后一个持有者释放后才停止poll线程
+     * @param name 线程组名
+     */
+    static void ReleaseGroup(const std::string &name);
+
+    /**
+     * 释放所有线程组
+     */
+    static void Release();
+
+    const std::string &GetName() const;
+
+    /**
+     * 设置默认的poll线程选择策略
+     * @param policy 选择策略
+     */
+    void SetSelectPolicy(PollThreadSelectPolicy policy);
+
+    PollThreadSelectPolicy GetSelectPolicy() const;
+
+    /**
+     * 按默认策略选择poll线程
+     */
     std::shared_ptr<PollThread> GetPollThread();
 
+    /**
+     * 按指定策略选择poll线程
+     * @param policy 选择策略
+     */
+    std::shared_ptr<PollThread> GetPollThread(PollThreadSelectPolicy policy);
+
+    /**
+     * 选择与socket相同的poll线程，该poll线程正在排空时按默认策略选择
+     * @param socket 亲和的socket
+     */
+    std::shared_ptr<PollThread> GetPollThread(const std::shared_ptr<Socket> &socket);
+
+    /**
+     * 选择numa节点上的poll线程，该节点上没有poll线程时按默认策略选择
+     * @param numa_node numa节点
+     */
+    std::shared_ptr<PollThread> GetPollThreadByNumaNode(int numa_node);
+
+    /**
+     * 获取每个poll线程所在的numa节点，未绑定到单个节点的为-1
+     */
+    std::vector<int> GetNumaNodes() const;
+
+    static int GetNumaNodeCount();
+
+    size_t GetSize() const;
+
+    /**
+     * 获取最近一次采样的平均利用率，未开启弹性伸缩时为0
+     */
+    double GetUtilization() const;
+
 private:
-    explicit PollThreadPool();
+    explicit PollThreadPool(std::string name);
+
+    ErrorCode Start(const PollThreadPoolConfig &config);
+
+    void Stop();
+
+    ErrorCode AddPollThread();
+
+    void RemovePollThread();
+
+    void DrainPollThread(const std::shared_ptr<PollThread> &poll_thread);
+
+    void ReleaseDrainedPollThreads();
+
+    void RunMonitor();
+
+    void Scale(int64_t elapsed_ns);
+
+    double SampleUtilization(int64_t elapsed_ns);
+
+    static std::vector<std::vector<int>> GetCpuSets(const PollThreadPoolConfig &config, int &pool_size);
+
+    size_t SelectByRoundRobin();
+
+    size_t SelectByLeastConnections() const;
+
+    size_t SelectByLeastQueuedBytes() const;
+
+    size_t SelectByPowerOfTwoChoices();
+
+    static bool IsLessLoaded(const std::shared_ptr<PollThread> &lhs, const std::shared_ptr<PollThread> &rhs);
 
 private:
+    std::string name_;
+    PollThreadPoolConfig config_;
+    std::vector<std::vector<int>> cpu_sets_;
+    mutable std::mutex pool_mutex_;
     std::vector<std::shared_ptr<PollThread>> pool_;
-    int index_ = 0;
+    std::vector<std::shared_ptr<PollThread>> draining_pool_;
+    int next_poll_thread_id_ = 0;
+    std::atomic<unsigned int> index_{0};
+    std::atomic<PollThreadSelectPolicy> policy_{PollThreadSelectPolicy::RoundRobin};
+    std::map<PollThread *, int64_t> busy_ns_map_;
+    std::atomic<double> utilization_{0};
+    int scale_up_count_ = 0;
+    int scale_down_count_ = 0;
+    std::mutex monitor_mutex_;
+    std::condition_variable monitor_condition_;
+    bool stop_monitor_ = false;
+    std::thread monitor_thread_;
 };
 
 #endif //POLL_THREAD_POOL_H
@@ -12,8 +12,6 @@ Session::Session(std::string id, std::shared_ptr<Socket> &socket)
 
 Session::~Session() {
     Close();
-
-    delete[] addr_;
 }
 
 const std::string &Session::GetId() const {
@@ -21,14 +19,15 @@ const std::string &Session::GetId() const {
 }
 
 void Session::SetAddress(sockaddr *addr, int addr_len) {
-    delete[] addr_;
-    addr_ = nullptr;
+    endpoint_ = Endpoint(addr, static_cast<socklen_t>(addr_len));
+}
 
-    if (addr && addr_len) {
-        addr_ = new char[addr_len];
-        memcpy(addr_, addr, addr_len);
-        addr_len_ = addr_len;
-    }
+void Session::SetEndpoint(const Endpoint &endpoint) {
+    endpoint_ = endpoint;
+}
+
+const Endpoint &Session::GetEndpoint() const {
+    return endpoint_;
 }
 
 void Session::SetErrorCallback(ErrorCallback callback) {
@@ -48,13 +47,25 @@ void Session::SetDisconnectedCallback(DisconnectedCallback callback) {
 }
 
 void Session::Send(std::shared_ptr<Buffer> &buf) {
-    if (addr_) {
-        socket_->SendTo(buf, addr_, addr_len_);
+    if (endpoint_.IsValid()) {
+        socket_->SendTo(buf, endpoint_);
     } else {
         socket_->Send(buf);
     }
 }
 
+void Session::EnableRecv(bool enabled) {
+    socket_->EnableRecv(enabled);
+}
+
+bool Session::IsRecvEnabled() const {
+    return socket_->IsRecvEnabled();
+}
+
+size_t Session::GetSendBufferCount() const {
+    return socket_->GetSendBufferCount();
+}
+
 void Session::Close() {
     socket_->Close();
 }
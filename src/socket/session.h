@@ -23,12 +23,26 @@ public:
 
     void SetAddress(sockaddr *addr, int addr_len);
 
+    void SetEndpoint(const Endpoint &endpoint);
+
+    const Endpoint &GetEndpoint() const;
+
     void SetErrorCallback(ErrorCallback callback);
 
     void SetDisconnectedCallback(DisconnectedCallback callback);
 
     void Send(std::shared_ptr<Buffer> &buf);
 
+    /**
+     * 关闭或开启数据接收，参考Socket::EnableRecv
+     * @param enabled 是否开启
+     */
+    void EnableRecv(bool enabled);
+
+    bool IsRecvEnabled() const;
+
+    size_t GetSendBufferCount() const;
+
     void Close();
 
 protected:
@@ -46,8 +60,7 @@ protected:
 
 protected:
     std::string id_;
-    char *addr_ = nullptr;
-    int addr_len_ = 0;
+    Endpoint endpoint_;
     std::shared_ptr<Socket> socket_;
     ErrorCallback error_callback_;
     DisconnectedCallback disconnected_callback_;
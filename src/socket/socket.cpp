@@ -3,9 +3,12 @@
 #include "socket.h"
 
 #include "spdlog/spdlog.h"
+#include "utils/buffer_pool.h"
 #include "utils/copy_buffer.h"
 #include "socket_utils.h"
 
+static constexpr int kMaxIovecCount = 64;
+
 Socket::Socket(std::string id, std::shared_ptr<PollThread> &poll_thread)
         : id_(std::move(id)), poll_thread_(poll_thread) {
     SPDLOG_DEBUG("create socket {0}", id_);
@@ -32,10 +35,10 @@ int Socket::GetRawSocket() const {
     return socket_fd_;
 }
 
-ErrorCode Socket::Initialize(SocketType type, bool async) {
+ErrorCode Socket::Initialize(SocketType type, bool async, int family) {
     switch (type) {
         case SocketType::TcpServer: {
-            socket_fd_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            socket_fd_ = socket(family, SOCK_STREAM, IPPROTO_TCP);
             if (socket_fd_ < 0) {
                 SPDLOG_ERROR("socket {} construct tcp socket failed with error {}, description '{}'",
                              id_, errno, strerror(errno));
@@ -49,7 +52,7 @@ ErrorCode Socket::Initialize(SocketType type, bool async) {
             break;
         }
         case SocketType::TcpClient: {
-            socket_fd_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            socket_fd_ = socket(family, SOCK_STREAM, IPPROTO_TCP);
             if (socket_fd_ < 0) {
                 SPDLOG_ERROR("socket {} construct tcp socket failed with error {}, description '{}'",
                              id_, errno, strerror(errno));
@@ -68,7 +71,7 @@ ErrorCode Socket::Initialize(SocketType type, bool async) {
             break;
         }
         case SocketType::Udp: {
-            socket_fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            socket_fd_ = socket(family, SOCK_DGRAM, IPPROTO_UDP);
             if (socket_fd_ < 0) {
                 SPDLOG_ERROR("socket {} construct udp socket failed with error {}, description '{}'",
                              id_, errno, strerror(errno));
@@ -202,7 +205,8 @@ void Socket::SetOnBeforeCreateCallback(OnBeforeCreateCallback callback) {
     if (callback == nullptr) {
         before_create_callback_ = [this]() {
             auto client_id = ++next_accepted_id_;
-            return std::make_shared<Socket>(fmt::format("{}-{}", id_, client_id), poll_thread_);
+            auto poll_thread = GetPollThread();
+            return std::make_shared<Socket>(fmt::format("{}-{}", id_, client_id), poll_thread);
         };
     } else {
         before_create_callback_ = std::move(callback);
@@ -210,6 +214,8 @@ void Socket::SetOnBeforeCreateCallback(OnBeforeCreateCallback callback) {
 }
 
 void Socket::SetOnSentResultCallback(OnSentResultCallback callback) {
+    // without a callback the sent buffer is never materialized as a shared_ptr
+    has_sent_result_callback_ = callback != nullptr;
     if (callback == nullptr) {
         sent_result_callback_ = [](Buffer::Ptr &, bool) {};
     } else {
@@ -234,15 +240,17 @@ ssize_t Socket::Send(Buffer::Ptr &buf, bool try_flush) {
 ssize_t Socket::SendTo(Buffer::Ptr &buf, const char *host, uint16_t port, bool try_flush) {
     SPDLOG_DEBUG("socket {0} send {1} bytes data to {2}:{3}", id_, buf->GetContentSize(), host, port);
 
-    sockaddr_in addr{};
-    auto addr_len = sizeof(addr);
-    memset(&addr, 0, addr_len);
+    Endpoint endpoint;
+    if (host == nullptr || !Endpoint::Parse(host, port, endpoint)) {
+        SPDLOG_ERROR("socket {0} send to invalid address {1}:{2}", id_, host ? host : "", port);
+        return -1;
+    }
 
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-    addr.sin_addr.s_addr = inet_addr(host);
+    return Send(buf, endpoint.GetAddress(), endpoint.GetAddressLength(), try_flush);
+}
 
-    return Send(buf, (sockaddr *) &addr, addr_len, try_flush);
+ssize_t Socket::SendTo(Buffer::Ptr &buf, const Endpoint &endpoint, bool try_flush) {
+    return Send(buf, endpoint.GetAddress(), endpoint.GetAddressLength(), try_flush);
 }
 
 ssize_t Socket::Send(Buffer::Ptr &buf, sockaddr *addr, socklen_t addr_len, bool try_flush) {
@@ -255,10 +263,46 @@ ssize_t Socket::Send(Buffer::Ptr &buf, sockaddr *addr, socklen_t addr_len, bool
         return 0;
     }
 
+    auto data = std::allocate_shared<BufferSock>(BufferPoolAllocator<BufferSock>(), buf, addr, addr_len);
+
+    return Enqueue(std::move(data), size, try_flush);
+}
+
+ssize_t Socket::Send(RefBuffer::Ref buf, bool try_flush) {
+    return Send(std::move(buf), nullptr, 0, try_flush);
+}
+
+ssize_t Socket::SendTo(RefBuffer::Ref buf, const Endpoint &endpoint, bool try_flush) {
+    return Send(std::move(buf), endpoint.GetAddress(), endpoint.GetAddressLength(), try_flush);
+}
+
+ssize_t Socket::Send(RefBuffer::Ref buf, sockaddr *addr, socklen_t addr_len, bool try_flush) {
+    if (socket_fd_ <= 0 || !buf) {
+        return 0;
+    }
+
+    // a local count is only safe when the last reference is moved in on the poll thread,
+    // otherwise the queue holds an atomic copy like RefBuffer::ToShared
+    if (buf->GetRefCountMode() == RefCountMode::Local &&
+        (buf->GetRefCount() != 1 || !GetPollThread()->IsCurrentThread())) {
+        buf = RefBuffer::Create(buf->GetData(), buf->GetContentSize(), RefCountMode::Atomic);
+    }
+
+    auto size = buf->GetContentSize();
+    if (size <= 0) {
+        return 0;
+    }
+
+    auto data = std::allocate_shared<BufferSock>(BufferPoolAllocator<BufferSock>(), std::move(buf), addr, addr_len);
+
+    return Enqueue(std::move(data), size, try_flush);
+}
+
+ssize_t Socket::Enqueue(std::shared_ptr<BufferSock> data, int size, bool try_flush) {
     {
         std::lock_guard<std::mutex> lock(send_queue_mutex_);
-        auto data = std::make_shared<BufferSock>(buf, addr, addr_len);
-        send_queue_.push_back(data);
+        send_queue_.push_back(std::move(data));
+        UpdateQueuedBytes(size);
     }
 
     if (try_flush && available_send_) {
@@ -271,6 +315,26 @@ ssize_t Socket::Send(Buffer::Ptr &buf, sockaddr *addr, socklen_t addr_len, bool
     return size;
 }
 
+ssize_t Socket::Send(const BufferChain::Ptr &chain, bool try_flush) {
+    Buffer::Ptr buf = chain->Snapshot();
+
+    return Send(buf, nullptr, 0, try_flush);
+}
+
+void Socket::EnableRecv(bool enabled) {
+    if (recv_enabled_.exchange(enabled) == enabled) {
+        return;
+    }
+
+    SPDLOG_DEBUG("socket {0} {1} receive", id_, enabled ? "resume" : "pause");
+
+    UpdatePollEvents();
+}
+
+bool Socket::IsRecvEnabled() const {
+    return recv_enabled_;
+}
+
 void Socket::SetSendTimeOutSecond(uint32_t seconds) {
 //    socket_->setSendTimeOutSecond(seconds);
 }
@@ -279,7 +343,10 @@ void Socket::Close() {
     SPDLOG_DEBUG("socket {0} close", id_);
 
     if (socket_fd_) {
-        UnRegisterEvent();
+        // sockets that were only bound or connected were never added to epoll
+        if (registered_) {
+            UnRegisterEvent();
+        }
         close(socket_fd_);
         socket_fd_ = 0;
     }
@@ -287,7 +354,11 @@ void Socket::Close() {
     socket_type_ = SocketType::Invalid;
     available_send_ = false;
 
-    send_queue_.clear();
+    {
+        std::lock_guard<std::mutex> lock(send_queue_mutex_);
+        send_queue_.clear();
+        UpdateQueuedBytes(-queued_bytes_);
+    }
     sending_buffer_.reset();
 
     try {
@@ -297,61 +368,209 @@ void Socket::Close() {
     }
 }
 
+size_t Socket::GetSendBufferCount() {
+    std::lock_guard<std::mutex> lock(send_queue_mutex_);
+    return send_queue_.size();
+}
+
+int64_t Socket::GetQueuedBytes() {
+    std::lock_guard<std::mutex> lock(send_queue_mutex_);
+    return queued_bytes_;
+}
+
+Endpoint Socket::GetLocalEndpoint() {
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getsockname(socket_fd_, (sockaddr *) &addr, &addr_len) != 0) {
+        return Endpoint();
+    }
+
+    return Endpoint((sockaddr *) &addr, addr_len);
+}
+
+Endpoint Socket::GetPeerEndpoint() {
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(socket_fd_, (sockaddr *) &addr, &addr_len) != 0) {
+        return Endpoint();
+    }
+
+    return Endpoint((sockaddr *) &addr, addr_len);
+}
+
 std::string Socket::GetLocalIp() {
-//    return socket_->get_local_ip();
-    return "";
+    return GetLocalEndpoint().GetIp();
 }
 
 uint16_t Socket::GetLocalPort() {
-//    return socket_->get_local_port();
-    return 0;
+    return GetLocalEndpoint().GetPort();
 }
 
 std::string Socket::GetPeerIp() {
-//    return socket_->get_peer_ip();
-    return "";
+    return GetPeerEndpoint().GetIp();
 }
 
 uint16_t Socket::GetPeerPort() {
-//    return socket_->get_peer_port();
-    return 0;
+    return GetPeerEndpoint().GetPort();
+}
+
+std::shared_ptr<PollThread> Socket::GetPollThread() const {
+    return std::atomic_load(&poll_thread_);
+}
+
+void Socket::MigrateTo(std::shared_ptr<PollThread> poll_thread, const PollThread::PollCompleteCallback &callback) {
+    auto current_poll_thread = GetPollThread();
+    if (poll_thread == nullptr || poll_thread == current_poll_thread) {
+        if (callback) {
+            callback(poll_thread != nullptr);
+        }
+        return;
+    }
+
+    SPDLOG_DEBUG("socket {0} migrate to poll thread", id_);
+
+    auto weak_self = weak_from_this();
+    auto error_code = current_poll_thread->Async([weak_self, poll_thread, callback]() {
+        auto strong_self = weak_self.lock();
+        if (strong_self == nullptr) {
+            if (callback) {
+                callback(false);
+            }
+            return;
+        }
+
+        strong_self->OnMigrate(poll_thread, callback);
+    });
+    if (error_code != Success && callback) {
+        callback(false);
+    }
+}
+
+void Socket::OnMigrate(const std::shared_ptr<PollThread> &poll_thread,
+                       const PollThread::PollCompleteCallback &callback) {
+    // run in the source poll thread, so no event callback of this socket was in progress
+    bool was_registered = registered_.exchange(false);
+    if (was_registered) {
+        GetPollThread()->DelEvent(socket_fd_, nullptr);
+    }
+
+    {
+        // senders may keep flushing while the events are re-registered, only the queued bytes
+        // accounting and the poll thread switch are serialized with them by the queue lock
+        std::lock_guard<std::mutex> lock(send_queue_mutex_);
+        GetPollThread()->UpdateQueuedBytes(-queued_bytes_);
+        std::atomic_store(&poll_thread_, poll_thread);
+        poll_thread->UpdateQueuedBytes(queued_bytes_);
+    }
+
+    if (was_registered) {
+        // epoll was level triggered, the pending readiness will be reported by the target poll thread,
+        // read and write flags changed meanwhile are applied by AddPollEvent
+        AddPollEvent();
+    }
+
+    if (callback) {
+        try {
+            callback(!was_registered || registered_);
+        } catch (std::exception &ex) {
+            SPDLOG_ERROR("socket {0} migrate callback raise exception '{1}'", id_, ex.what());
+        }
+    }
 }
 
 void Socket::RegisterEvent() {
-    int event = 0;
-    if (socket_type_ == SocketType::TcpServer) {
-        event = Event_Readable | Event_Error;
-    } else if (socket_type_ == SocketType::TcpClient || socket_type_ == SocketType::Udp) {
-        event = Event_Readable | Event_Writable | Event_Error;
+    writable_event_enabled_ = (socket_type_ == SocketType::TcpClient || socket_type_ == SocketType::Udp);
+
+    AddPollEvent();
+}
+
+void Socket::AddPollEvent() {
+    auto poll_thread = GetPollThread();
+    auto busy_poll_us = poll_thread->GetSocketBusyPollMicroseconds();
+    if (busy_poll_us > 0 && socket_type_ != SocketType::TcpServer) {
+        SocketUtils::setBusyPoll(socket_fd_, busy_poll_us, poll_thread->IsSocketPreferBusyPoll());
     }
 
     auto weak_self = weak_from_this();
-    poll_thread_->AddEvent(socket_fd_, event, [weak_self](int event) {
+    auto events = GetPollEvents();
+    auto error_code = poll_thread->AddEvent(socket_fd_, events, [weak_self](int event) {
         auto strong_self = weak_self.lock();
         if (strong_self == nullptr) {
             return;
         }
 
         strong_self->OnPollEvent(event);
+    }, [weak_self](const std::shared_ptr<PollThread> &poll_thread) {
+        auto strong_self = weak_self.lock();
+        if (strong_self == nullptr) {
+            return;
+        }
+
+        strong_self->MigrateTo(poll_thread);
     });
+
+    registered_ = (error_code == Success);
+
+    // a flag changed by a sender before registered_ was set skipped UpdatePollEvents
+    if (registered_ && GetPollEvents() != events) {
+        UpdatePollEvents();
+    }
 }
 
 void Socket::StartWritableEvent() {
     SPDLOG_DEBUG("socket {0} start writable event", id_);
     available_send_ = false;
 
-    auto event = Event_Readable | Event_Writable | Event_Error;
-    poll_thread_->ModifyEvent(socket_fd_, event, nullptr);
+    writable_event_enabled_ = true;
+    UpdatePollEvents();
 }
 
 void Socket::StopWritableEvent() {
     SPDLOG_DEBUG("socket {0} stop writable event", id_);
-    auto event = Event_Readable | Event_Error;
-    poll_thread_->ModifyEvent(socket_fd_, event, nullptr);
+
+    writable_event_enabled_ = false;
+    UpdatePollEvents();
+}
+
+int Socket::GetPollEvents() const {
+    int event = Event_Error;
+    if (recv_enabled_) {
+        event |= Event_Readable;
+    }
+
+    if (writable_event_enabled_) {
+        event |= Event_Writable;
+    }
+
+    return event;
+}
+
+void Socket::UpdatePollEvents() {
+    if (!registered_) {
+        return;
+    }
+
+    // the mask is computed by the poll thread when applied, a request deferred from another thread
+    // never overwrites a later change with the flags it read earlier
+    auto weak_self = weak_from_this();
+    GetPollThread()->RefreshEvent(socket_fd_, [weak_self]() {
+        auto strong_self = weak_self.lock();
+        if (strong_self == nullptr) {
+            return static_cast<int>(Event_Error);
+        }
+
+        return strong_self->GetPollEvents();
+    });
 }
 
 void Socket::UnRegisterEvent() {
-    poll_thread_->DelEvent(socket_fd_, nullptr);
+    registered_ = false;
+    GetPollThread()->DelEvent(socket_fd_, nullptr);
+}
+
+void Socket::UpdateQueuedBytes(int64_t delta) {
+    queued_bytes_ += delta;
+    GetPollThread()->UpdateQueuedBytes(delta);
 }
 
 void Socket::OnPollEvent(int event) {
@@ -375,10 +594,9 @@ void Socket::OnPollEvent(int event) {
 void Socket::OnAcceptEvent() {
     SPDLOG_DEBUG("socket {0} received accept event", id_);
 
-    sockaddr_in remote_addr{};
-    memset(&remote_addr, 0, sizeof(remote_addr));
-    auto sin_size = sizeof(sockaddr_in);
-    auto client_fd = accept(socket_fd_, (sockaddr *) (&remote_addr), (socklen_t *) &sin_size);
+    sockaddr_storage remote_addr{};
+    socklen_t sin_size = sizeof(remote_addr);
+    auto client_fd = accept(socket_fd_, (sockaddr *) (&remote_addr), &sin_size);
     if (client_fd < 0) {
         SPDLOG_ERROR("socket {0} server accept failed with error {1}, description '{2}'",
                      id_, errno, strerror(errno));
@@ -394,6 +612,12 @@ void Socket::OnAcceptEvent() {
     SocketUtils::setCloExec(client_fd);
 
     auto client_socket = before_create_callback_();
+    if (client_socket == nullptr || client_socket->GetPollThread() == nullptr) {
+        SPDLOG_ERROR("socket {0} has no poll thread for the accepted connection, close it", id_);
+        close(client_fd);
+        return;
+    }
+
     client_socket->socket_fd_ = client_fd;
     client_socket->socket_type_ = SocketType::TcpClient;
     client_socket->RegisterEvent();
@@ -408,16 +632,18 @@ void Socket::OnAcceptEvent() {
 void Socket::OnReadableEvent() {
     SPDLOG_DEBUG("socket {0} received readable event", id_);
 
-    auto read_buffer = poll_thread_->GetSharedReadBuffer();
+    auto read_buffer = GetPollThread()->GetSharedReadBuffer();
 
     auto data = read_buffer->GetWritableData();
     auto capacity = read_buffer->GetCapacity();
 
-    sockaddr_in addr{};
-    socklen_t addr_len = sizeof(addr);
+    sockaddr_storage addr{};
+    socklen_t addr_len;
 
     while (true) {
-        memset(&addr, 0, addr_len);
+        // the shared buffer only holds the data of one recv, callbacks must retain what they keep
+        read_buffer->Reset();
+        addr_len = sizeof(addr);
         auto read_count = recvfrom(socket_fd_, data, capacity, 0, (sockaddr *) &addr, &addr_len);
         if (read_count < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -446,6 +672,11 @@ void Socket::OnReadableEvent() {
         } catch (std::exception &ex) {
             SPDLOG_ERROR("socket {0} read callback raise exception '{1}'", id_, ex.what());
         }
+
+        if (!recv_enabled_) {
+            // receive was paused by the read callback, leave the rest in the kernel buffer
+            break;
+        }
     }
 }
 
@@ -505,6 +736,79 @@ void Socket::OnErrorEvent() {
     }
 }
 
+ssize_t Socket::SendChain(const BufferChain &chain, int offset) {
+    iovec iov[kMaxIovecCount];
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = static_cast<size_t>(chain.GetIovec(iov, kMaxIovecCount, offset));
+    if (socket_type_ == SocketType::Udp) {
+        msg.msg_name = sending_buffer_->GetAddress();
+        msg.msg_namelen = sending_buffer_->GetAddressLength();
+    }
+
+    return ::sendmsg(socket_fd_, &msg, send_flags_);
+}
+
+bool Socket::SendCurrentBuffer() {
+    ssize_t sent_count;
+    auto chain = sending_buffer_->GetChain();
+    if (chain && (chain->GetSegmentCount() <= 1 ||
+                  (socket_type_ == SocketType::Udp && chain->GetSegmentCount() > kMaxIovecCount))) {
+        // a datagram must go out in one call, too many segments are flattened instead
+        chain = nullptr;
+    }
+
+    while (true) {
+        auto size = sending_buffer_->GetContentSize() - sending_buffer_->GetOffset();
+        if (size == 0) {
+            return true;
+        }
+
+        SPDLOG_DEBUG("socket {0} send data with {1} bytes", id_, size);
+
+        if (chain) {
+            sent_count = SendChain(*chain, static_cast<int>(sending_buffer_->GetOffset()));
+        } else {
+            auto data = sending_buffer_->GetData() + sending_buffer_->GetOffset();
+            if (socket_type_ == SocketType::Udp) {
+                sent_count = ::sendto(socket_fd_, data, size, send_flags_,
+                                      sending_buffer_->GetAddress(), sending_buffer_->GetAddressLength());
+            } else {
+                sent_count = ::send(socket_fd_, data, size, send_flags_);
+            }
+        }
+
+        if (sent_count >= 0) {
+            sending_buffer_->UpdateSentDataCount(sent_count);
+            continue;
+        }
+
+        auto error = errno;
+        if (error == EAGAIN || error == EWOULDBLOCK) {
+            // send buffer was full
+            return true;
+        }
+
+        SPDLOG_ERROR("socket {0} send failed with error {1}, description '{2}'", id_, error, strerror(error));
+        try {
+            if (has_sent_result_callback_) {
+                auto buffer = sending_buffer_->GetBuffer();
+                sent_result_callback_(buffer, false);
+            }
+        } catch (std::exception &ex) {
+            SPDLOG_WARN("socket {0} sent result callback raise exception '{1}'", id_, ex.what());
+        }
+
+        auto failed_size = sending_buffer_->GetContentSize();
+        sending_buffer_.reset();
+
+        std::lock_guard<std::mutex> lock_queue(send_queue_mutex_);
+        UpdateQueuedBytes(-failed_size);
+
+        return false;
+    }
+}
+
 void Socket::Flush(bool by_poll_thread) {
     SPDLOG_DEBUG("socket {0} flush by poll thread {1}", id_, by_poll_thread);
 
@@ -518,71 +822,62 @@ void Socket::Flush(bool by_poll_thread) {
         return;
     }
 
+    bool close_connection = false;
     {
         std::lock_guard<std::mutex> lock(sending_buffer_mutex_);
         if (sending_buffer_ && sending_buffer_->IsFinished()) {
-            auto sent_data = sending_buffer_->GetBuffer();
-            sent_result_callback_(sent_data, true);
+            if (has_sent_result_callback_) {
+                auto sent_data = sending_buffer_->GetBuffer();
+                sent_result_callback_(sent_data, true);
+            }
+            auto sent_size = sending_buffer_->GetContentSize();
             sending_buffer_.reset();
-        }
 
-        if (sending_buffer_ == nullptr) {
             std::lock_guard<std::mutex> lock_queue(send_queue_mutex_);
-            if (!send_queue_.empty()) {
-                sending_buffer_ = send_queue_.front();
-                send_queue_.pop_front();
-            }
-        }
-
-        if (sending_buffer_ == nullptr) {
-            SPDLOG_DEBUG("socket {0} has no data to send", id_);
-            StopWritableEvent();
-
-            return;
+            UpdateQueuedBytes(-sent_size);
         }
 
-        ssize_t sent_count;
-        auto buffer = sending_buffer_->GetBuffer();
-
         while (true) {
-            auto data = buffer->GetData() + sending_buffer_->GetOffset();
-            auto size = buffer->GetContentSize() - sending_buffer_->GetOffset();
-            if (size == 0) {
-                break;
+            if (sending_buffer_ == nullptr) {
+                std::lock_guard<std::mutex> lock_queue(send_queue_mutex_);
+                if (!send_queue_.empty()) {
+                    sending_buffer_ = std::move(send_queue_.front());
+                    send_queue_.pop_front();
+                } else {
+                    // a sender enqueuing after this check must flush by itself, the writable event is stopped
+                    available_send_ = true;
+                }
             }
 
-            SPDLOG_DEBUG("socket {0} send data with {1} bytes", id_, size);
+            if (sending_buffer_ == nullptr) {
+                SPDLOG_DEBUG("socket {0} has no data to send", id_);
+                StopWritableEvent();
 
-            if (socket_type_ == SocketType::Udp) {
-                sent_count = ::sendto(socket_fd_, data, size, send_flags_,
-                                      sending_buffer_->GetAddress(), sending_buffer_->GetAddressLength());
-            } else {
-                sent_count = ::send(socket_fd_, data, size, send_flags_);
+                return;
             }
 
-            if (sent_count < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    // send buffer was full
-                    break;
+            if (!SendCurrentBuffer()) {
+                // a failed datagram does not affect the next one, a stream can not continue
+                if (socket_type_ == SocketType::Udp) {
+                    continue;
                 }
 
-                SPDLOG_ERROR("socket {0} send failed with error {1}, description '{2}'",
-                             id_, errno, strerror(errno));
-                try {
-                    sent_result_callback_(buffer, false);
-                } catch (std::exception &ex) {
-                    SPDLOG_WARN("socket {0} sent result callback raise exception '{1}'", id_, ex.what());
-                }
-                // TODO: should close the connection here?
-            } else {
-                sending_buffer_->UpdateSentDataCount(sent_count);
+                close_connection = true;
             }
+            break;
         }
 
-        available_send_ = false;
+        if (!close_connection) {
+            available_send_ = false;
 
-        if (!by_poll_thread) {
-            StartWritableEvent();
+            // a stale writable event may flush after the writable event was stopped
+            if (!by_poll_thread || !writable_event_enabled_) {
+                StartWritableEvent();
+            }
         }
     }
+
+    if (close_connection) {
+        Close();
+    }
 }
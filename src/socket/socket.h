@@ -2,13 +2,16 @@
 #define SOCKET_H
 
 #include <functional>
+#include <deque>
 #include <memory>
-#include <list>
 #include <unistd.h>
 
+#include "endpoint.h"
 #include "poll_thread.h"
 #include "utils/buffer.h"
+#include "utils/buffer_chain.h"
 #include "utils/buffer_sock.h"
+#include "utils/ref_buffer.h"
 
 enum class SocketType {
     Invalid = 0,
@@ -36,7 +39,13 @@ public:
 
     int GetRawSocket() const;
 
-    ErrorCode Initialize(SocketType type, bool async = true);
+    /**
+     * 创建socket
+     * @param type socket类型
+     * @param async 是否非阻塞
+     * @param family 地址族，AF_INET或AF_INET6
+     */
+    ErrorCode Initialize(SocketType type, bool async = true, int family = AF_INET);
 
     ErrorCode Bind(uint16_t port, const std::string &local_ip = "0.0.0.0");
 
@@ -69,17 +78,20 @@ public:
     //bool fromSock(int fd, SockNum::SockType type);
 
     /**
-     * 从另外一个Socket克隆
-     * 目的是一个socket可以被多个poller对象监听，提高性能或实现Socket归属线程的迁移
-     * @param other 原始的socket对象
-     * @return 是否成功
+     * 将socket迁移到另一个poller线程
+     * 在原poller线程中注销事件监听后注册到目标poller线程，发送队列、读写事件状态保持不变
+     * 迁移完成后所有事件回调都在目标poller线程中触发
+     * @param poll_thread 目标poller线程
+     * @param callback 迁移结果回调，在原poller线程中触发
      */
-    //bool cloneSocket(const Socket &other);
+    void MigrateTo(std::shared_ptr<PollThread> poll_thread,
+                   const PollThread::PollCompleteCallback &callback = nullptr);
 
     ////////////设置事件回调////////////
 
     /**
      * 设置数据接收回调,tcp或udp客户端有效
+     * 回调中的buffer是poll线程共享的接收缓存，只在回调期间有效，需要保留或异步转发时先SliceBuffer::Retain
      * @param cb 回调对象
      */
     void SetOnReadCallback(OnReadCallback callback);
@@ -141,10 +153,30 @@ public:
      */
     ssize_t Send(Buffer::Ptr &buf, bool try_flush = true);
 
+    /**
+     * 发送到ip地址，每次都会解析ip字符串，频繁发送时应缓存Endpoint
+     */
     ssize_t SendTo(Buffer::Ptr &buf, const char *host = nullptr, uint16_t port = 0, bool try_flush = true);
 
+    ssize_t SendTo(Buffer::Ptr &buf, const Endpoint &endpoint, bool try_flush = true);
+
     ssize_t Send(Buffer::Ptr &buf, sockaddr *addr, socklen_t addr_len, bool try_flush);
 
+    /**
+     * 发送分段buffer，放入发送队列的是chain的快照，各分段不拷贝，通过writev/sendmsg一次发送
+     */
+    ssize_t Send(const BufferChain::Ptr &chain, bool try_flush = true);
+
+    /**
+     * 发送RefBuffer，数据不拷贝，引用由发送队列的BufferSock直接持有，不再包装为Buffer::Ptr
+     * Local模式的buffer需要把最后一个引用move进来，并且Send与poll线程为同一线程，否则拷贝为Atomic模式的buffer再发送
+     */
+    ssize_t Send(RefBuffer::Ref buf, bool try_flush = true);
+
+    ssize_t SendTo(RefBuffer::Ref buf, const Endpoint &endpoint, bool try_flush = true);
+
+    ssize_t Send(RefBuffer::Ref buf, sockaddr *addr, socklen_t addr_len, bool try_flush);
+
     /**
      * 尝试将所有数据写socket
      * @return -1代表失败(socket无效或者发送超时)，0代表成功?
@@ -160,9 +192,16 @@ public:
 
     /**
      * 关闭或开启数据接收
+     * 关闭时仅移除读事件监听，不会注销socket，重新开启后继续接收内核缓存中的数据
+     * 通过该接口可以实现接收流控
      * @param enabled 是否开启
      */
-    //void enableRecv(bool enabled);
+    void EnableRecv(bool enabled);
+
+    /**
+     * 是否开启了数据接收
+     */
+    bool IsRecvEnabled() const;
 
     /**
      * tcp客户端是否处于连接状态
@@ -191,7 +230,7 @@ public:
      * 获取poller线程对象
      * @return poller线程对象
      */
-    //const EventPoller::Ptr &getPoller() const;
+    std::shared_ptr<PollThread> GetPollThread() const;
 
     /**
      * 绑定udp 目标地址，后续发送时就不用再单独指定了
@@ -216,7 +255,12 @@ public:
     /**
      * 获取发送缓存包个数(不是字节数)
      */
-    //size_t getSendBufferCount();
+    size_t GetSendBufferCount();
+
+    /**
+     * 获取发送缓存字节数，包含正在发送的包
+     */
+    int64_t GetQueuedBytes();
 
     /**
      * 获取上次socket发送缓存清空至今的毫秒数,单位毫秒
@@ -235,6 +279,10 @@ public:
 
     ////////////SockInfo ////////////
 
+    Endpoint GetLocalEndpoint();
+
+    Endpoint GetPeerEndpoint();
+
     std::string GetLocalIp();
 
     uint16_t GetLocalPort();
@@ -246,10 +294,20 @@ public:
 private:
     void RegisterEvent();
 
+    void AddPollEvent();
+
+    void OnMigrate(const std::shared_ptr<PollThread> &poll_thread, const PollThread::PollCompleteCallback &callback);
+
     void StartWritableEvent();
 
     void StopWritableEvent();
 
+    int GetPollEvents() const;
+
+    void UpdatePollEvents();
+
+    void UpdateQueuedBytes(int64_t delta);
+
     void UnRegisterEvent();
 
     void OnPollEvent(int event);
@@ -264,6 +322,16 @@ private:
 
     void Flush(bool by_poll_thread);
 
+    /**
+     * 发送sending_buffer_直到发完或发送缓冲区满
+     * 发送出错时回调发送失败、丢弃sending_buffer_并返回false
+     */
+    bool SendCurrentBuffer();
+
+    ssize_t SendChain(const BufferChain &chain, int offset);
+
+    ssize_t Enqueue(std::shared_ptr<BufferSock> data, int size, bool try_flush);
+
 private:
     std::string id_;
     std::shared_ptr<PollThread> poll_thread_;
@@ -276,12 +344,17 @@ private:
     OnAcceptCallback accept_callback_;
     OnBeforeCreateCallback before_create_callback_;
     OnSentResultCallback sent_result_callback_;
+    bool has_sent_result_callback_ = false;
     OnClosedCallback closed_callback_;
     std::mutex send_queue_mutex_;
-    std::list<std::shared_ptr<BufferSock>> send_queue_;
+    std::deque<std::shared_ptr<BufferSock>> send_queue_;
+    int64_t queued_bytes_ = 0;
     std::mutex sending_buffer_mutex_;
     std::shared_ptr<BufferSock> sending_buffer_ = nullptr;
     std::atomic<bool> available_send_ = {false};
+    std::atomic<bool> registered_{false};
+    std::atomic<bool> recv_enabled_{true};
+    std::atomic<bool> writable_event_enabled_{false};
     int send_flags_ = 0;
     std::atomic<bool> connecting_{false};
     int next_accepted_id_ = 0;
@@ -12,25 +12,36 @@
 
 #include "spdlog/spdlog.h"
 
-static ErrorCode bind_sock4(int fd, const char *ifr_ip, uint16_t port);
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+static ErrorCode bind_sock(int fd, const char *ifr_ip, uint16_t port);
 
 static int get_uv_error();
 
 static int uv_translate_posix_error(int err);
 
 ErrorCode SocketUtils::bind(int fd, uint16_t port, const char *local_ip) {
-    return bind_sock4(fd, local_ip, port);
+    return bind_sock(fd, local_ip, port);
 }
 
 ErrorCode SocketUtils::connect(int fd, const char *host, uint16_t port, bool async) {
-    sockaddr_in dest_addr{};
-    memset(&dest_addr, 0, sizeof(dest_addr));
+    Endpoint endpoint;
+    if (!Endpoint::Parse(host, port, endpoint)) {
+        SPDLOG_ERROR("socket connect to invalid address {0}:{1}", host, port);
+        return Socket_Connect_Failed;
+    }
 
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(port);
-    dest_addr.sin_addr.s_addr = inet_addr(host);
+    return connect(fd, endpoint, async);
+}
 
-    if (::connect(fd, (sockaddr *) &dest_addr, sizeof(sockaddr)) == 0) {
+ErrorCode SocketUtils::connect(int fd, const Endpoint &endpoint, bool async) {
+    if (::connect(fd, endpoint.GetAddress(), endpoint.GetAddressLength()) == 0) {
         //同步连接成功
         return Success;
     }
@@ -40,8 +51,8 @@ ErrorCode SocketUtils::connect(int fd, const char *host, uint16_t port, bool asy
         return Socket_Connect_In_Progress;
     }
 
-    SPDLOG_ERROR("socket connect to {0}:{1} failed with error {2}, description '{3}'",
-                 host, port, errno, strerror(errno));
+    SPDLOG_ERROR("socket connect to {0} failed with error {1}, description '{2}'",
+                 endpoint.ToString(), errno, strerror(errno));
 
     return Socket_Connect_Failed;
 }
@@ -168,21 +179,50 @@ int SocketUtils::setCloseWait(int fd, int second) {
     return 0;
 }
 
-static ErrorCode bind_sock4(int fd, const char *ifr_ip, uint16_t port) {
-    sockaddr_in addr{};
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    if (port > 0) {
-        addr.sin_port = htons(port);
+int SocketUtils::setBusyPoll(int fd, int microseconds, bool prefer) {
+    int ret = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, (char *) &microseconds, sizeof(microseconds));
+    if (ret == -1) {
+        SPDLOG_TRACE("setsockopt SO_BUSY_POLL failed with error {0}, description '{1}'", errno, strerror(errno));
+
+        return ret;
     }
 
-    if (ifr_ip == nullptr || strcmp(ifr_ip, "0.0.0.0") == 0) {
-        addr.sin_addr.s_addr = INADDR_ANY;
-    } else {
-        addr.sin_addr.s_addr = inet_addr(ifr_ip);
+    if (prefer) {
+        int opt = 1;
+        ret = setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, (char *) &opt, sizeof(opt));
+        if (ret == -1) {
+            SPDLOG_TRACE("setsockopt SO_PREFER_BUSY_POLL failed with error {0}, description '{1}'",
+                         errno, strerror(errno));
+
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static ErrorCode bind_sock(int fd, const char *ifr_ip, uint16_t port) {
+    sockaddr_storage local_addr{};
+    socklen_t local_len = sizeof(local_addr);
+    getsockname(fd, (sockaddr *) &local_addr, &local_len);
+
+    if (ifr_ip == nullptr) {
+        ifr_ip = "0.0.0.0";
+    }
+
+    // the any address follows the family of the socket
+    std::string ip = ifr_ip;
+    if (local_addr.ss_family == AF_INET6 && ip == "0.0.0.0") {
+        ip = "::";
+    }
+
+    Endpoint endpoint;
+    if (!Endpoint::Parse(ip, port, endpoint)) {
+        SPDLOG_ERROR("socket bind to invalid address {0}:{1}", ifr_ip, port);
+        return Socket_Bind_Failed;
     }
 
-    if (::bind(fd, (struct sockaddr *) &addr, sizeof(sockaddr)) == -1) {
+    if (::bind(fd, endpoint.GetAddress(), endpoint.GetAddressLength()) == -1) {
         SPDLOG_ERROR("socket bind to {0}:{1} failed with error {2}, description '{3}'",
                      ifr_ip, port, errno, strerror(errno));
         if (errno == EADDRINUSE) {
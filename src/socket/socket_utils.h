@@ -5,6 +5,7 @@
 #include <string>
 
 #include "error_code.h"
+#include "endpoint.h"
 
 static constexpr int SOCKET_DEFAULT_BUF_SIZE = 256 * 1024;
 
@@ -22,6 +23,8 @@ public:
     */
     static ErrorCode connect(int fd, const char *host, uint16_t port, bool async = true);
 
+    static ErrorCode connect(int fd, const Endpoint &endpoint, bool async = true);
+
     /**
      * 创建tcp监听套接字
      * @param fd 套接字
@@ -95,6 +98,15 @@ public:
      */
     static int setCloseWait(int sock, int second = 0);
 
+    /**
+     * 开启SO_BUSY_POLL，阻塞读或者epoll时在网卡队列上忙轮询，降低收包延时
+     * @param fd socket fd号
+     * @param microseconds 忙轮询时间，单位微秒，0为关闭
+     * @param prefer 是否开启SO_PREFER_BUSY_POLL，忙轮询期间抑制软中断
+     * @return 0代表成功，-1为失败
+     */
+    static int setBusyPoll(int fd, int microseconds, bool prefer = false);
+
 private:
     SocketUtils() {}
 };
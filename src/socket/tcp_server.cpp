@@ -9,6 +9,12 @@ TcpServer::TcpServer(std::string id, std::shared_ptr<PollThread> &poll_thread)
     SetNewSessionCallback(nullptr);
 }
 
+TcpServer::TcpServer(std::string id, PollThreadPool::Ptr poll_thread_pool)
+        : id_(std::move(id)), poll_thread_pool_(std::move(poll_thread_pool)) {
+    SetSessionCreator(nullptr);
+    SetNewSessionCallback(nullptr);
+}
+
 TcpServer::~TcpServer() {
     Stop();
 }
@@ -31,13 +37,27 @@ void TcpServer::SetNewSessionCallback(TcpServer::NewSessionCallback callback) {
     }
 }
 
+void TcpServer::SetPollThreadPool(PollThreadPool::Ptr poll_thread_pool) {
+    poll_thread_pool_ = std::move(poll_thread_pool);
+}
+
 ErrorCode TcpServer::Start(uint16_t port, const std::string &host, int backlog) {
     ErrorCode error_code;
     if (listen_socket_) {
         return Already_Initialized;
     }
 
-    listen_socket_ = std::make_shared<Socket>(id_, poll_thread_);
+    // selected on start and not held by the server, the group may drain it later
+    auto poll_thread = poll_thread_;
+    if (poll_thread == nullptr && poll_thread_pool_) {
+        poll_thread = poll_thread_pool_->GetPollThread();
+    }
+    if (poll_thread == nullptr) {
+        SPDLOG_ERROR("tcp server {} has no poll thread to listen on", id_);
+        return Socket_Create_Failed;
+    }
+
+    listen_socket_ = std::make_shared<Socket>(id_, poll_thread);
     error_code = listen_socket_->Initialize(SocketType::TcpServer, true);
     if (error_code != Success) {
         SPDLOG_ERROR("tcp server {} initialize failed with error 0x{:08X}", id_, int(error_code));
@@ -89,7 +109,33 @@ void TcpServer::SetListenSocketCallback() {
         strong_self->OnAccepted(sock, addr, addr_len);
     });
 
+    if (poll_thread_pool_) {
+        auto poll_thread_pool = poll_thread_pool_;
+        std::weak_ptr<Socket> weak_listen_socket = listen_socket_;
+        listen_socket_->SetOnBeforeCreateCallback([weak_self, weak_listen_socket,
+                                                   poll_thread_pool]() -> std::shared_ptr<Socket> {
+            auto strong_self = weak_self.lock();
+            auto listen_socket = weak_listen_socket.lock();
+            if (strong_self == nullptr || listen_socket == nullptr) {
+                return nullptr;
+            }
+
+            auto poll_thread = poll_thread_pool->GetPollThread();
+            if (poll_thread == nullptr) {
+                // the group was stopped or is empty, keep the connection on the listening thread,
+                // which follows the listen socket when it was migrated
+                SPDLOG_WARN("tcp server {} poll thread pool {} has no poll thread, use the listening one",
+                            strong_self->id_, poll_thread_pool->GetName());
+                poll_thread = listen_socket->GetPollThread();
+            }
+
+            auto socket_id = fmt::format("{}-{}", strong_self->id_, ++strong_self->next_socket_index_);
+            return std::make_shared<Socket>(socket_id, poll_thread);
+        });
+    }
+
     next_session_index_ = 0;
+    next_socket_index_ = 0;
 }
 
 void TcpServer::OnError(ErrorCode error_code) {
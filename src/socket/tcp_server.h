@@ -7,12 +7,20 @@
 #include <memory>
 
 #include "error_code.h"
+#include "poll_thread_pool.h"
 #include "session.h"
 
 class TcpServer : public std::enable_shared_from_this<TcpServer> {
 public:
     explicit TcpServer(std::string id, std::shared_ptr<PollThread> &poll_thread);
 
+    /**
+     * 监听socket和接收的连接都使用线程组中的poll线程，服务器持有线程组直到析构
+     * @param id 服务器id
+     * @param poll_thread_pool 线程组
+     */
+    explicit TcpServer(std::string id, PollThreadPool::Ptr poll_thread_pool);
+
     ~TcpServer();
 
     using SessionCreator = std::function<std::shared_ptr<Session>(const std::string &id,
@@ -25,6 +33,13 @@ public:
 
     void SetNewSessionCallback(NewSessionCallback callback);
 
+    /**
+     * 设置接收的连接所使用的线程组，为空时使用监听socket的poll线程，需要在Start之前调用
+     * 线程组中没有可用的poll线程时，接收的连接使用监听socket的poll线程
+     * @param poll_thread_pool 线程组
+     */
+    void SetPollThreadPool(PollThreadPool::Ptr poll_thread_pool);
+
     ErrorCode Start(uint16_t port, const std::string &host = "0.0.0.0", int backlog = 1024);
 
     void Stop();
@@ -39,10 +54,12 @@ private:
 private:
     std::string id_;
     std::shared_ptr<PollThread> poll_thread_;
+    PollThreadPool::Ptr poll_thread_pool_ = nullptr;
     std::shared_ptr<Socket> listen_socket_ = nullptr;
     SessionCreator session_creator_;
     NewSessionCallback new_session_callback_;
     int next_session_index_ = 0;
+    int next_socket_index_ = 0;
 };
 
 #endif //TCP_SERVER_H
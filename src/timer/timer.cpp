@@ -1,55 +1,36 @@
 #include "timer.h"
 
-#include "spdlog/spdlog.h"
-
-Timer::Timer(long id)
-        : id_(id) {
+Timer::Timer(long id, const TimerCallback &callback, int64_t period_us)
+        : id_(id), period_us_(period_us), callback_(std::make_shared<TimerCallback>(callback)) {
 }
 
-Timer::~Timer() {
-    Cancel();
-}
+Timer::~Timer() = default;
 
 long Timer::GetId() const {
     return id_;
 }
 
-void Timer::Start(long microseconds, const std::function<void()> &callback) {
-    microseconds_ = microseconds;
-    callback_ = callback;
-    work_thread_ = std::thread([this]() {
-        RunLoop();
-    });
+bool Timer::IsPeriodic() const {
+    return period_us_ > 0;
 }
 
-void Timer::Cancel() {
-    stop_flag_ = true;
-    condition_variable_.notify_one();
-
-    if (work_thread_.joinable()) {
-        work_thread_.join();
-    }
+int64_t Timer::GetPeriod() const {
+    return period_us_;
 }
 
-bool Timer::IsStopped() const {
-    return stop_flag_;
+int64_t Timer::GetExpireTime() const {
+    return expire_time_us_;
 }
 
-void Timer::RunLoop() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    condition_variable_.wait_for(lock, std::chrono::microseconds(microseconds_), [this]() {
-        return bool(stop_flag_);
-    });
-
-    if (stop_flag_) {
-        return;
-    }
+void Timer::SetExpireTime(int64_t expire_time_us, uint64_t expire_tick) {
+    expire_time_us_ = expire_time_us;
+    expire_tick_ = expire_tick;
+}
 
-    try {
-        callback_();
-    } catch (std::exception &ex) {
-        SPDLOG_ERROR("timer {} callback raised exception {}", id_, ex.what());
-    }
+uint64_t Timer::GetExpireTick() const {
+    return expire_tick_;
+}
 
-    stop_flag_ = true;
+const std::shared_ptr<Timer::TimerCallback> &Timer::GetCallback() const {
+    return callback_;
 }
@@ -1,38 +1,55 @@
 #ifndef TIMER_H
 #define TIMER_H
 
-#include <atomic>
-#include <condition_variable>
+#include <cstdint>
 #include <functional>
-#include <mutex>
-#include <thread>
+#include <memory>
 
+class TimingWheel;
+
+class TimerManager;
+
+/**
+ * 定时器节点，挂在时间轮的槽位链表上，由TimerManager管理
+ */
 class Timer {
 public:
-    explicit Timer(long id);
+    using TimerCallback = std::function<void()>;
+
+    explicit Timer(long id, const TimerCallback &callback, int64_t period_us = 0);
+
+    Timer(const Timer &other) = delete;
+
+    Timer &operator=(const Timer &other) = delete;
 
     ~Timer();
 
 public:
     long GetId() const;
 
-    void Start(long microseconds, const std::function<void()> &callback);
+    bool IsPeriodic() const;
 
-    void Cancel();
+    int64_t GetPeriod() const;
 
-    bool IsStopped() const;
+    int64_t GetExpireTime() const;
 
-private:
-    void RunLoop();
+    void SetExpireTime(int64_t expire_time_us, uint64_t expire_tick);
+
+    uint64_t GetExpireTick() const;
+
+    const std::shared_ptr<TimerCallback> &GetCallback() const;
 
 private:
+    friend class TimingWheel;
+
     long id_ = 0;
-    long microseconds_ = 0;
-    std::function<void()> callback_;
-    std::thread work_thread_;
-    std::atomic<bool> stop_flag_{false};
-    std::mutex mutex_;
-    std::condition_variable condition_variable_;
+    int64_t period_us_ = 0;
+    int64_t expire_time_us_ = 0;
+    uint64_t expire_tick_ = 0;
+    std::shared_ptr<TimerCallback> callback_;
+    Timer *prev_ = nullptr;
+    Timer *next_ = nullptr;
+    Timer **slot_ = nullptr;
 };
 
 #endif //TIMER_H
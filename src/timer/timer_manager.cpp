@@ -1,54 +1,165 @@
 #include "timer_manager.h"
 
+#include <limits>
+
+#include "spdlog/spdlog.h"
+
 static TimerManager *instance = nullptr;
 
+static std::once_flag instance_flag;
+
 TimerManager *TimerManager::GetInstance() {
-    if (instance == nullptr) {
+    std::call_once(instance_flag, []() {
         instance = new TimerManager();
-    }
+    });
 
     return instance;
 }
 
-TimerManager::TimerManager() = default;
+TimerManager::TimerManager()
+        : start_time_(std::chrono::steady_clock::now()) {
+    work_thread_ = std::thread(&TimerManager::RunLoop, this);
+}
 
 TimerManager::~TimerManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_flag_ = true;
+    }
+    cond_.notify_one();
+
+    if (work_thread_.joinable()) {
+        work_thread_.join();
+    }
+
     timer_map_.clear();
 }
 
 long TimerManager::After(long microseconds, const TimerCallback &callback) {
-    auto timer_id = next_timer_id_++;
-    auto timer = std::make_shared<Timer>(timer_id);
-    timer->Start(microseconds, [this, callback, timer_id]() {
-        auto it = timer_map_.find(timer_id);
+    return AddTimer(microseconds, 0, callback);
+}
+
+long TimerManager::Every(long microseconds, const TimerCallback &callback) {
+    if (microseconds <= 0) {
+        return -1;
+    }
+
+    return AddTimer(microseconds, microseconds, callback);
+}
+
+void TimerManager::Cancel(long id) {
+    std::unique_ptr<Timer> timer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = timer_map_.find(id);
         if (it == timer_map_.end()) {
             return;
         }
 
-        callback();
-    });
+        wheel_.Remove(it->second.get());
+        timer = std::move(it->second);
+        timer_map_.erase(it);
+    }
+}
 
-    timer_map_[timer_id] = timer;
+size_t TimerManager::GetTimerCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timer_map_.size();
+}
 
-    ClearStoppedTimers();
+long TimerManager::AddTimer(long delay, long period, const TimerCallback &callback) {
+    if (delay < 0) {
+        delay = 0;
+    }
 
-    return timer_id;
-}
+    auto expire_time = GetNowMicroseconds() + delay;
+    auto expire_tick = ToTick(expire_time);
+    bool notify;
+    long timer_id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timer_id = next_timer_id_++;
 
-void TimerManager::Cancel(long id) {
-    auto it = timer_map_.find(id);
-    if (it == timer_map_.end()) {
-        return;
+        std::unique_ptr<Timer> timer(new Timer(timer_id, callback, period));
+        timer->SetExpireTime(expire_time, expire_tick);
+        wheel_.Add(timer.get());
+        timer_map_[timer_id] = std::move(timer);
+
+        // only wake the worker up when it sleeps past the new timer
+        notify = expire_tick < wakeup_tick_;
+        if (notify) {
+            wakeup_tick_ = expire_tick;
+        }
+    }
+
+    if (notify) {
+        cond_.notify_one();
     }
 
-    it->second->Cancel();
-    timer_map_.erase(it);
+    return timer_id;
 }
 
-void TimerManager::ClearStoppedTimers() {
-    for (auto &it: timer_map_) {
-        if (it.second->IsStopped()) {
-            timer_map_.erase(it.first);
+void TimerManager::RunLoop() {
+    std::vector<Timer *> expired;
+    std::vector<std::shared_ptr<TimerCallback>> callbacks;
+    std::vector<std::unique_ptr<Timer>> finished;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_flag_) {
+        auto now = GetNowMicroseconds();
+        wheel_.Advance(now / kTickMicroseconds, expired);
+
+        if (!expired.empty()) {
+            for (auto timer: expired) {
+                callbacks.push_back(timer->GetCallback());
+
+                if (timer->IsPeriodic()) {
+                    // schedule from the planned time instead of now, skip the periods already missed
+                    auto period = timer->GetPeriod();
+                    auto next_time = timer->GetExpireTime() + period;
+                    if (next_time <= now) {
+                        next_time += ((now - next_time) / period + 1) * period;
+                    }
+                    timer->SetExpireTime(next_time, ToTick(next_time));
+                    wheel_.Add(timer);
+                    continue;
+                }
+
+                auto it = timer_map_.find(timer->GetId());
+                finished.push_back(std::move(it->second));
+                timer_map_.erase(it);
+            }
+            expired.clear();
+
+            lock.unlock();
+            for (auto &callback: callbacks) {
+                try {
+                    (*callback)();
+                } catch (const std::exception &e) {
+                    SPDLOG_ERROR("timer callback throw exception: {}", e.what());
+                }
+            }
+            callbacks.clear();
+            finished.clear();
+            lock.lock();
+            continue;
+        }
+
+        wakeup_tick_ = wheel_.GetNextExpireTick();
+        if (wakeup_tick_ == std::numeric_limits<uint64_t>::max()) {
+            cond_.wait(lock);
+        } else {
+            cond_.wait_until(lock, start_time_ + std::chrono::microseconds(wakeup_tick_ * kTickMicroseconds));
         }
+        wakeup_tick_ = 0;
     }
 }
+
+int64_t TimerManager::GetNowMicroseconds() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time_).count();
+}
+
+uint64_t TimerManager::ToTick(int64_t microseconds) {
+    return static_cast<uint64_t>((microseconds + kTickMicroseconds - 1) / kTickMicroseconds);
+}
@@ -1,10 +1,19 @@
 #ifndef TIMER_MANAGER_H
 #define TIMER_MANAGER_H
 
-#include <map>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "timer.h"
+#include "timing_wheel.h"
 
+/**
+ * 定时器管理，所有定时器挂在同一个分层时间轮上，由一个工作线程驱动
+ * 定时精度为一个tick(kTickMicroseconds)，回调在工作线程中执行
+ */
 class TimerManager {
 public:
     static TimerManager *GetInstance();
@@ -16,16 +25,39 @@ public:
 public:
     long After(long microseconds, const TimerCallback &callback);
 
+    /**
+     * 周期定时器，按首次启动时间对齐，回调执行慢时跳过错过的周期，不会累积漂移
+     */
+    long Every(long microseconds, const TimerCallback &callback);
+
     void Cancel(long id);
 
+    size_t GetTimerCount();
+
+public:
+    static constexpr long kTickMicroseconds = 1000;
+
 private:
     TimerManager();
 
-    void ClearStoppedTimers();
+    long AddTimer(long delay, long period, const TimerCallback &callback);
+
+    void RunLoop();
+
+    int64_t GetNowMicroseconds() const;
+
+    static uint64_t ToTick(int64_t microseconds);
 
 private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread work_thread_;
+    bool stop_flag_ = false;
+    uint64_t wakeup_tick_ = 0;
     long next_timer_id_ = 1000;
-    std::map<long, std::shared_ptr<Timer>> timer_map_;
+    std::chrono::steady_clock::time_point start_time_;
+    TimingWheel wheel_;
+    std::unordered_map<long, std::unique_ptr<Timer>> timer_map_;
 };
 
 #endif //TIMER_MANAGER_H
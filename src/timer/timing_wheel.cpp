@@ -0,0 +1,144 @@
+#include "timing_wheel.h"
+
+#include <limits>
+
+TimingWheel::TimingWheel(uint64_t current_tick)
+        : current_tick_(current_tick) {
+}
+
+TimingWheel::~TimingWheel() = default;
+
+void TimingWheel::Add(Timer *timer) {
+    Link(timer);
+    ++size_;
+}
+
+void TimingWheel::Remove(Timer *timer) {
+    if (timer->slot_ == nullptr) {
+        return;
+    }
+
+    Unlink(timer);
+    --size_;
+}
+
+void TimingWheel::Advance(uint64_t tick, std::vector<Timer *> &expired) {
+    while (current_tick_ <= tick) {
+        if (size_ == 0) {
+            current_tick_ = tick + 1;
+            break;
+        }
+
+        auto index = static_cast<int>(current_tick_ & kRootMask);
+        if (index == 0) {
+            // move the timers of the next block down, stop at the first level that was not wrapped
+            for (int level = 0; level < kLevelCount; ++level) {
+                auto level_index = static_cast<int>((current_tick_ >> (kRootBits + level * kLevelBits)) & kLevelMask);
+                Cascade(level, level_index);
+                if (level_index != 0) {
+                    break;
+                }
+            }
+        }
+
+        auto timer = root_[index];
+        root_[index] = nullptr;
+        while (timer) {
+            auto next = timer->next_;
+            timer->prev_ = nullptr;
+            timer->next_ = nullptr;
+            timer->slot_ = nullptr;
+            expired.push_back(timer);
+            --size_;
+            timer = next;
+        }
+
+        ++current_tick_;
+    }
+}
+
+uint64_t TimingWheel::GetNextExpireTick() const {
+    if (size_ == 0) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    auto index = static_cast<int>(current_tick_ & kRootMask);
+    for (int i = index; i < kRootSize; ++i) {
+        if (root_[i]) {
+            return current_tick_ + (i - index);
+        }
+    }
+
+    // the timers of the upper levels will not expire before the next cascade
+    return current_tick_ + (kRootSize - index);
+}
+
+uint64_t TimingWheel::GetCurrentTick() const {
+    return current_tick_;
+}
+
+size_t TimingWheel::GetSize() const {
+    return size_;
+}
+
+void TimingWheel::Link(Timer *timer) {
+    auto expire_tick = timer->expire_tick_;
+    Timer **slot;
+
+    if (expire_tick < current_tick_) {
+        // already expired, run it with the next tick
+        slot = &root_[current_tick_ & kRootMask];
+    } else {
+        auto delta = expire_tick - current_tick_;
+        if (delta < static_cast<uint64_t>(kRootSize)) {
+            slot = &root_[expire_tick & kRootMask];
+        } else {
+            int level = 0;
+            while (level < kLevelCount - 1 && delta >= (1ULL << (kRootBits + (level + 1) * kLevelBits))) {
+                ++level;
+            }
+
+            auto max_delta = (1ULL << (kRootBits + kLevelCount * kLevelBits)) - 1;
+            if (delta > max_delta) {
+                expire_tick = current_tick_ + max_delta;
+            }
+
+            slot = &levels_[level][(expire_tick >> (kRootBits + level * kLevelBits)) & kLevelMask];
+        }
+    }
+
+    timer->slot_ = slot;
+    timer->prev_ = nullptr;
+    timer->next_ = *slot;
+    if (*slot) {
+        (*slot)->prev_ = timer;
+    }
+    *slot = timer;
+}
+
+void TimingWheel::Unlink(Timer *timer) {
+    if (timer->prev_) {
+        timer->prev_->next_ = timer->next_;
+    } else {
+        *timer->slot_ = timer->next_;
+    }
+
+    if (timer->next_) {
+        timer->next_->prev_ = timer->prev_;
+    }
+
+    timer->prev_ = nullptr;
+    timer->next_ = nullptr;
+    timer->slot_ = nullptr;
+}
+
+void TimingWheel::Cascade(int level, int index) {
+    auto timer = levels_[level][index];
+    levels_[level][index] = nullptr;
+
+    while (timer) {
+        auto next = timer->next_;
+        Link(timer);
+        timer = next;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "timer.h"
+
+/**
+ * 分层时间轮，插入和删除都是O(1)
+ * 第一层256个槽位，每个槽位一个tick，其余4层各64个槽位，最大定时2^32个tick
+ * 非线程安全，由调用者加锁
+ */
+class TimingWheel {
+public:
+    explicit TimingWheel(uint64_t current_tick = 0);
+
+    TimingWheel(const TimingWheel &other) = delete;
+
+    TimingWheel &operator=(const TimingWheel &other) = delete;
+
+    ~TimingWheel();
+
+public:
+    void Add(Timer *timer);
+
+    void Remove(Timer *timer);
+
+    /**
+     * 推进时间轮到tick(包含)，取出所有到期的定时器
+     * @param tick 当前tick
+     * @param expired 到期的定时器
+     */
+    void Advance(uint64_t tick, std::vector<Timer *> &expired);
+
+    /**
+     * 下一个可能有定时器到期的tick，没有定时器时返回UINT64_MAX
+     */
+    uint64_t GetNextExpireTick() const;
+
+    uint64_t GetCurrentTick() const;
+
+    size_t GetSize() const;
+
+private:
+    void Link(Timer *timer);
+
+    static void Unlink(Timer *timer);
+
+    void Cascade(int level, int index);
+
+private:
+    static constexpr int kRootBits = 8;
+    static constexpr int kLevelBits = 6;
+    static constexpr int kRootSize = 1 << kRootBits;
+    static constexpr int kLevelSize = 1 << kLevelBits;
+    static constexpr int kRootMask = kRootSize - 1;
+    static constexpr int kLevelMask = kLevelSize - 1;
+    static constexpr int kLevelCount = 4;
+
+    uint64_t current_tick_;
+    size_t size_ = 0;
+    Timer *root_[kRootSize] = {nullptr};
+    Timer *levels_[kLevelCount][kLevelSize] = {{nullptr}};
+};
+
+#endif //TIMING_WHEEL_H
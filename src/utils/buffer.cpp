@@ -17,3 +17,7 @@ const char *Buffer::GetData() const {
 int Buffer::GetContentSize() const {
     return content_size_;
 }
+
+bool Buffer::IsRetainable() const {
+    return false;
+}
@@ -20,6 +20,12 @@ public:
 
     virtual int GetContentSize() const;
 
+    /**
+     * 数据是否由buffer自身持有并且不会再被修改，可以不拷贝直接引用(发送队列、切片)
+     * 外部指针包装的buffer返回false
+     */
+    virtual bool IsRetainable() const;
+
 private:
     const char *buffer_;
     int content_size_;
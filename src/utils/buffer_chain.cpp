@@ -0,0 +1,225 @@
+#include "buffer_chain.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "copy_buffer.h"
+#include "slice_buffer.h"
+
+BufferChain::BufferChain() = default;
+
+BufferChain::~BufferChain() = default;
+
+const char *BufferChain::GetData() const {
+    if (segments_.empty()) {
+        return nullptr;
+    }
+
+    if (segments_.size() == 1) {
+        return segments_.front()->GetData();
+    }
+
+    auto flat_buffer = std::atomic_load(&flat_buffer_);
+    if (flat_buffer == nullptr) {
+        auto copy = CopyBuffer::Create(nullptr, content_size_);
+        Peek(copy->GetWritableData(), content_size_);
+
+        // a snapshot may be read by several poll threads, the first copy wins and is never replaced
+        Buffer::Ptr expected = nullptr;
+        flat_buffer = copy;
+        if (!std::atomic_compare_exchange_strong(&flat_buffer_, &expected, flat_buffer)) {
+            flat_buffer = expected;
+        }
+    }
+
+    return flat_buffer->GetData();
+}
+
+ErrorCode BufferChain::Flatten() {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    if (segments_.size() <= 1) {
+        return Success;
+    }
+
+    GetData();
+    segments_.clear();
+    segments_.push_back(std::move(flat_buffer_));
+
+    return Success;
+}
+
+int BufferChain::GetContentSize() const {
+    return content_size_;
+}
+
+bool BufferChain::IsRetainable() const {
+    return frozen_;
+}
+
+ErrorCode BufferChain::Append(const Buffer::Ptr &buffer) {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    if (buffer == nullptr || buffer->GetContentSize() <= 0) {
+        return Success;
+    }
+
+    segments_.push_back(SliceBuffer::Retain(buffer));
+    flat_buffer_.reset();
+    content_size_ += buffer->GetContentSize();
+
+    return Success;
+}
+
+ErrorCode BufferChain::Append(const char *data, int length) {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    if (length <= 0) {
+        return Success;
+    }
+
+    segments_.push_back(CopyBuffer::Create(data, length));
+    flat_buffer_.reset();
+    content_size_ += length;
+
+    return Success;
+}
+
+ErrorCode BufferChain::Prepend(const Buffer::Ptr &buffer) {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    if (buffer == nullptr || buffer->GetContentSize() <= 0) {
+        return Success;
+    }
+
+    segments_.push_front(SliceBuffer::Retain(buffer));
+    flat_buffer_.reset();
+    content_size_ += buffer->GetContentSize();
+
+    return Success;
+}
+
+ErrorCode BufferChain::Prepend(const char *data, int length) {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    if (length <= 0) {
+        return Success;
+    }
+
+    segments_.push_front(CopyBuffer::Create(data, length));
+    flat_buffer_.reset();
+    content_size_ += length;
+
+    return Success;
+}
+
+int BufferChain::Peek(char *data, int length, int offset) const {
+    int copied = 0;
+
+    for (auto &segment: segments_) {
+        if (copied >= length) {
+            break;
+        }
+
+        auto size = segment->GetContentSize();
+        if (offset >= size) {
+            offset -= size;
+            continue;
+        }
+
+        auto count = std::min(size - offset, length - copied);
+        memcpy(data + copied, segment->GetData() + offset, count);
+        copied += count;
+        offset = 0;
+    }
+
+    return copied;
+}
+
+ErrorCode BufferChain::Consume(int length) {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    if (length > 0) {
+        flat_buffer_.reset();
+    }
+
+    while (length > 0 && !segments_.empty()) {
+        auto &segment = segments_.front();
+        auto size = segment->GetContentSize();
+        if (length < size) {
+            segment = SliceBuffer::Create(segment, length, size - length);
+            content_size_ -= length;
+            break;
+        }
+
+        segments_.pop_front();
+        content_size_ -= size;
+        length -= size;
+    }
+
+    return Success;
+}
+
+ErrorCode BufferChain::Clear() {
+    if (frozen_) {
+        return Buffer_Read_Only;
+    }
+
+    segments_.clear();
+    flat_buffer_.reset();
+    content_size_ = 0;
+
+    return Success;
+}
+
+size_t BufferChain::GetSegmentCount() const {
+    return segments_.size();
+}
+
+const Buffer::Ptr &BufferChain::GetSegment(size_t index) const {
+    return segments_[index];
+}
+
+int BufferChain::GetIovec(iovec *iov, int max_count, int offset) const {
+    int count = 0;
+
+    for (auto &segment: segments_) {
+        if (count >= max_count) {
+            break;
+        }
+
+        auto size = segment->GetContentSize();
+        if (offset >= size) {
+            offset -= size;
+            continue;
+        }
+
+        iov[count].iov_base = const_cast<char *>(segment->GetData() + offset);
+        iov[count].iov_len = static_cast<size_t>(size - offset);
+        ++count;
+        offset = 0;
+    }
+
+    return count;
+}
+
+BufferChain::Ptr BufferChain::Snapshot() const {
+    auto snapshot = std::make_shared<BufferChain>();
+    snapshot->segments_ = segments_;
+    snapshot->content_size_ = content_size_;
+    snapshot->frozen_ = true;
+
+    return snapshot;
+}
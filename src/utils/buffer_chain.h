@@ -0,0 +1,93 @@
+#ifndef BUFFER_CHAIN_H
+#define BUFFER_CHAIN_H
+
+#include <deque>
+#include <memory>
+#include <sys/uio.h>
+
+#include "buffer.h"
+
+/**
+ * 由多个buffer分段组成的buffer，追加和在头部插入都不拷贝数据，可以直接转为iovec用writev/sendmsg发送
+ * 不可引用(IsRetainable)的分段在加入时拷贝一次
+ * 快照是只读的，可以被多个线程同时读取，修改快照返回Buffer_Read_Only
+ */
+class BufferChain : public Buffer {
+public:
+    using Ptr = std::shared_ptr<BufferChain>;
+
+    explicit BufferChain();
+
+    BufferChain(const BufferChain &other) = delete;
+
+    BufferChain &operator=(const BufferChain &other) = delete;
+
+    ~BufferChain() override;
+
+public:
+    /**
+     * 获取连续的数据，多个分段时返回合并后的缓存副本(拷贝一次)，分段本身不变，修改chain后副本失效
+     * 快照的副本只创建一次，并发调用是安全的
+     */
+    const char *GetData() const override;
+
+    /**
+     * 把多个分段合并为一个分段(拷贝一次)
+     */
+    ErrorCode Flatten();
+
+    int GetContentSize() const override;
+
+    /**
+     * 快照之外的chain可以继续修改，不能直接引用
+     */
+    bool IsRetainable() const override;
+
+    ErrorCode Append(const Buffer::Ptr &buffer);
+
+    ErrorCode Append(const char *data, int length);
+
+    ErrorCode Prepend(const Buffer::Ptr &buffer);
+
+    ErrorCode Prepend(const char *data, int length);
+
+    /**
+     * 从offset开始拷贝最多length字节到data，可以跨分段
+     * @return 实际拷贝的字节数
+     */
+    int Peek(char *data, int length, int offset = 0) const;
+
+    /**
+     * 从头部移除length字节，分段只移除一部分时替换为切片
+     */
+    ErrorCode Consume(int length);
+
+    ErrorCode Clear();
+
+    size_t GetSegmentCount() const;
+
+    const Buffer::Ptr &GetSegment(size_t index) const;
+
+    /**
+     * 从offset开始的数据填充到iovec数组
+     * @param iov iovec数组
+     * @param max_count iovec数组长度
+     * @param offset 起始偏移
+     * @return 填充的iovec个数
+     */
+    int GetIovec(iovec *iov, int max_count, int offset = 0) const;
+
+    /**
+     * 创建共享所有分段的只读快照，快照可以直接放入发送队列，之后修改原chain不影响快照
+     */
+    Ptr Snapshot() const;
+
+private:
+    std::deque<Buffer::Ptr> segments_;
+    // GetData在多个分段时的合并副本，通过std::atomic_load/atomic_compare_exchange访问
+    mutable Buffer::Ptr flat_buffer_ = nullptr;
+    int content_size_ = 0;
+    bool frozen_ = false;
+};
+
+#endif //BUFFER_CHAIN_H
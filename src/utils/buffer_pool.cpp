@@ -0,0 +1,202 @@
+#include "buffer_pool.h"
+
+#include <malloc.h>
+#include <mutex>
+#include <new>
+
+static constexpr int kSizeClassCount = 11;
+static constexpr size_t kThreadCacheBytes = 256 * 1024;
+static constexpr size_t kCentralCacheBytes = 4 * 1024 * 1024;
+static constexpr size_t kMinCacheCount = 4;
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+struct FreeList {
+    FreeBlock *head = nullptr;
+    size_t count = 0;
+
+    void Push(char *data) {
+        auto block = reinterpret_cast<FreeBlock *>(data);
+        block->next = head;
+        head = block;
+        ++count;
+    }
+
+    char *Pop() {
+        auto block = head;
+        head = block->next;
+        --count;
+        return reinterpret_cast<char *>(block);
+    }
+};
+
+struct CentralList {
+    std::mutex mutex;
+    FreeList list;
+};
+
+static CentralList central_lists[kSizeClassCount];
+
+static size_t get_class_size(int size_class) {
+    return BufferPool::kMinBlockSize << size_class;
+}
+
+static int get_size_class(size_t size) {
+    int size_class = 0;
+    while (get_class_size(size_class) < size) {
+        ++size_class;
+    }
+
+    return size_class;
+}
+
+static size_t get_max_count(int size_class, size_t bytes) {
+    auto count = bytes / get_class_size(size_class);
+    return count < kMinCacheCount ? kMinCacheCount : count;
+}
+
+static void free_list(FreeList &list) {
+    while (list.count > 0) {
+        ::operator delete(list.Pop());
+    }
+}
+
+// move count blocks from the thread cache to the central list, free them when the central list is full
+static void release_to_central(int size_class, FreeList &list, size_t count) {
+    auto max_count = get_max_count(size_class, kCentralCacheBytes);
+    FreeList overflow;
+    {
+        auto &central = central_lists[size_class];
+        std::lock_guard<std::mutex> lock(central.mutex);
+        while (count-- > 0 && list.count > 0) {
+            if (central.list.count < max_count) {
+                central.list.Push(list.Pop());
+            } else {
+                overflow.Push(list.Pop());
+            }
+        }
+    }
+
+    free_list(overflow);
+}
+
+static void fetch_from_central(int size_class, FreeList &list, size_t count) {
+    auto &central = central_lists[size_class];
+    std::lock_guard<std::mutex> lock(central.mutex);
+    while (count-- > 0 && central.list.count > 0) {
+        list.Push(central.list.Pop());
+    }
+}
+
+struct ThreadCache {
+    FreeList lists[kSizeClassCount];
+
+    void Release() {
+        for (int size_class = 0; size_class < kSizeClassCount; ++size_class) {
+            if (lists[size_class].count > 0) {
+                release_to_central(size_class, lists[size_class], lists[size_class].count);
+            }
+        }
+    }
+
+    ~ThreadCache() {
+        Release();
+    }
+};
+
+static thread_local ThreadCache thread_cache;
+
+static_assert(BufferPool::kMinBlockSize << (kSizeClassCount - 1) == BufferPool::kMaxPooledSize,
+              "size classes must end at the max pooled size");
+
+constexpr size_t BufferPool::kMinBlockSize;
+
+constexpr size_t BufferPool::kMaxPooledSize;
+
+const std::shared_ptr<BufferPool> &BufferPool::GetInstance() {
+    // never destroyed, thread caches are released to it at thread exit
+    static auto instance = new std::shared_ptr<BufferPool>(new BufferPool());
+    return *instance;
+}
+
+BufferPool::BufferPool() = default;
+
+BufferPool::~BufferPool() = default;
+
+char *BufferPool::Allocate(size_t size) {
+    if (size > kMaxPooledSize) {
+        return static_cast<char *>(::operator new(size));
+    }
+
+    auto size_class = get_size_class(size);
+    auto &list = thread_cache.lists[size_class];
+    if (list.count == 0) {
+        fetch_from_central(size_class, list, get_max_count(size_class, kThreadCacheBytes) / 2);
+        if (list.count == 0) {
+            return static_cast<char *>(::operator new(get_class_size(size_class)));
+        }
+    }
+
+    return list.Pop();
+}
+
+void BufferPool::Deallocate(char *data, size_t size) {
+    if (data == nullptr) {
+        return;
+    }
+
+    if (size > kMaxPooledSize) {
+        ::operator delete(data);
+        return;
+    }
+
+    auto size_class = get_size_class(size);
+    auto &list = thread_cache.lists[size_class];
+    list.Push(data);
+
+    auto max_count = get_max_count(size_class, kThreadCacheBytes);
+    if (list.count > max_count) {
+        release_to_central(size_class, list, max_count / 2);
+    }
+}
+
+void BufferPool::ReleaseThreadCache() {
+    thread_cache.Release();
+}
+
+void BufferPool::Trim() {
+    thread_cache.Release();
+
+    for (auto &central: central_lists) {
+        FreeList list;
+        {
+            std::lock_guard<std::mutex> lock(central.mutex);
+            list = central.list;
+            central.list = FreeList();
+        }
+        free_list(list);
+    }
+
+    malloc_trim(0);
+}
+
+size_t BufferPool::GetCachedBytes() const {
+    size_t bytes = 0;
+    for (int size_class = 0; size_class < kSizeClassCount; ++size_class) {
+        auto &central = central_lists[size_class];
+        std::lock_guard<std::mutex> lock(central.mutex);
+        bytes += central.list.count * get_class_size(size_class);
+    }
+
+    return bytes;
+}
+
+size_t BufferPool::GetBlockSize(size_t size) {
+    if (size > kMaxPooledSize) {
+        return size;
+    }
+
+    return get_class_size(get_size_class(size));
+}
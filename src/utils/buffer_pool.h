@@ -0,0 +1,87 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+#include <memory>
+
+#include "memory_allocator.h"
+
+/**
+ * 按大小分级的内存池，用于消息buffer等小块内存的频繁分配释放
+ * 每个线程有自己的空闲链表，不加锁；超出上限时批量归还到全局链表，其他线程批量取用
+ * 因此在一个线程分配、另一个线程释放的内存也会回到池中
+ * 全局链表有上限，超出的内存直接释放；大于kMaxPooledSize的内存不进池
+ */
+class BufferPool : public MemoryAllocator {
+public:
+    static const std::shared_ptr<BufferPool> &GetInstance();
+
+    ~BufferPool() override;
+
+public:
+    char *Allocate(size_t size) override;
+
+    void Deallocate(char *data, size_t size) override;
+
+    /**
+     * 将当前线程缓存的内存归还到全局链表，poll线程空闲时调用
+     */
+    void ReleaseThreadCache();
+
+    /**
+     * 归还当前线程的缓存并释放全局链表中所有空闲内存
+     */
+    void Trim();
+
+    /**
+     * 全局链表中空闲内存的字节数，不包含各线程的缓存
+     */
+    size_t GetCachedBytes() const;
+
+    /**
+     * 实际分配的内存大小
+     */
+    static size_t GetBlockSize(size_t size);
+
+public:
+    static constexpr size_t kMinBlockSize = 64;
+    static constexpr size_t kMaxPooledSize = 64 * 1024;
+
+private:
+    BufferPool();
+};
+
+/**
+ * 从BufferPool分配内存的STL分配器，可以配合std::allocate_shared使用
+ */
+template<typename T>
+class BufferPoolAllocator {
+public:
+    using value_type = T;
+
+    BufferPoolAllocator() = default;
+
+    template<typename U>
+    BufferPoolAllocator(const BufferPoolAllocator<U> &other) {
+    }
+
+    T *allocate(size_t n) {
+        return reinterpret_cast<T *>(BufferPool::GetInstance()->Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *data, size_t n) {
+        BufferPool::GetInstance()->Deallocate(reinterpret_cast<char *>(data), n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const BufferPoolAllocator<T> &, const BufferPoolAllocator<U> &) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const BufferPoolAllocator<T> &, const BufferPoolAllocator<U> &) {
+    return false;
+}
+
+#endif //BUFFER_POOL_H
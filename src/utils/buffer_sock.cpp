@@ -2,24 +2,68 @@
 
 #include <cstring>
 
+#include "buffer_chain.h"
+
+constexpr int BufferSock::kInlineSize;
+
 BufferSock::BufferSock(std::shared_ptr<Buffer> &buffer, sockaddr *address, socklen_t addr_len)
-        : addr_len_(addr_len) {
-    if (buffer->GetContentSize() > 0) {
-        buffer_ = std::make_shared<CopyBuffer>(buffer);
+        : content_size_(buffer->GetContentSize()),
+          inline_buffer_(inline_data_, buffer->GetContentSize() <= kInlineSize ? buffer->GetContentSize() : 0) {
+    if (content_size_ > 0) {
+        if (buffer->IsRetainable()) {
+            buffer_ = buffer;
+        } else if (content_size_ <= kInlineSize) {
+            memcpy(inline_data_, buffer->GetData(), content_size_);
+        } else {
+            auto chain = std::dynamic_pointer_cast<BufferChain>(buffer);
+            if (chain) {
+                buffer_ = chain->Snapshot();
+            } else {
+                buffer_ = CopyBuffer::Create(buffer->GetData(), content_size_);
+            }
+        }
     }
 
-    if (addr_len > 0) {
-        addr_ = new char[addr_len_];
-        memcpy(addr_, address, addr_len);
-    }
+    SetAddress(address, addr_len);
 }
 
-BufferSock::~BufferSock() {
-    delete[] addr_;
+BufferSock::BufferSock(RefBuffer::Ref buffer, sockaddr *address, socklen_t addr_len)
+        : ref_buffer_(std::move(buffer)) {
+    content_size_ = ref_buffer_ ? ref_buffer_->GetContentSize() : 0;
+
+    SetAddress(address, addr_len);
 }
 
+BufferSock::~BufferSock() = default;
+
 std::shared_ptr<Buffer> BufferSock::GetBuffer() const {
-    return buffer_;
+    if (buffer_) {
+        return buffer_;
+    }
+
+    if (ref_buffer_) {
+        return RefBuffer::ToShared(ref_buffer_);
+    }
+
+    // the inline buffer lives as long as this object
+    auto self = std::const_pointer_cast<BufferSock>(shared_from_this());
+    return std::shared_ptr<Buffer>(self, &self->inline_buffer_);
+}
+
+const BufferChain *BufferSock::GetChain() const {
+    return dynamic_cast<const BufferChain *>(buffer_.get());
+}
+
+const char *BufferSock::GetData() const {
+    if (buffer_) {
+        return buffer_->GetData();
+    }
+
+    return ref_buffer_ ? ref_buffer_->GetData() : inline_data_;
+}
+
+int BufferSock::GetContentSize() const {
+    return content_size_;
 }
 
 bool BufferSock::ContainAddress() const {
@@ -27,7 +71,7 @@ bool BufferSock::ContainAddress() const {
 }
 
 sockaddr *BufferSock::GetAddress() const {
-    return (sockaddr *) addr_;
+    return (sockaddr *) &addr_;
 }
 
 socklen_t BufferSock::GetAddressLength() const {
@@ -43,5 +87,12 @@ void BufferSock::UpdateSentDataCount(ssize_t count) {
 }
 
 bool BufferSock::IsFinished() const {
-    return offset_ >= buffer_->GetContentSize();
+    return offset_ >= content_size_;
+}
+
+void BufferSock::SetAddress(sockaddr *address, socklen_t addr_len) {
+    if (address && addr_len > 0) {
+        addr_len_ = addr_len <= sizeof(addr_) ? addr_len : sizeof(addr_);
+        memcpy(&addr_, address, addr_len_);
+    }
 }
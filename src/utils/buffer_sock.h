@@ -5,11 +5,23 @@
 
 #include "buffer.h"
 #include "copy_buffer.h"
+#include "ref_buffer.h"
 
-class BufferSock {
+class BufferChain;
+
+/**
+ * 发送队列中的一项，目标地址和不超过kInlineSize的小消息直接保存在对象内，不再单独分配
+ * 需要由shared_ptr管理，小消息的GetBuffer返回共享本对象的buffer
+ */
+class BufferSock : public std::enable_shared_from_this<BufferSock> {
 public:
     explicit BufferSock(std::shared_ptr<Buffer> &buffer, sockaddr *address, socklen_t addr_len);
 
+    /**
+     * 直接接管RefBuffer的引用，不做拷贝
+     */
+    explicit BufferSock(RefBuffer::Ref buffer, sockaddr *address, socklen_t addr_len);
+
     BufferSock(BufferSock &other) = delete;
 
     BufferSock operator=(BufferSock &other) = delete;
@@ -17,8 +29,20 @@ public:
     ~BufferSock();
 
 public:
+    /**
+     * 返回发送的数据，小消息和RefBuffer需要构造新的shared_ptr，只在需要回调时调用
+     */
     std::shared_ptr<Buffer> GetBuffer() const;
 
+    /**
+     * 数据为BufferChain时返回它，否则返回nullptr，不修改引用计数
+     */
+    const BufferChain *GetChain() const;
+
+    const char *GetData() const;
+
+    int GetContentSize() const;
+
     bool ContainAddress() const;
 
     sockaddr *GetAddress() const;
@@ -31,11 +55,21 @@ public:
 
     bool IsFinished() const;
 
+public:
+    static constexpr int kInlineSize = 128;
+
 private:
-    std::shared_ptr<CopyBuffer> buffer_ = nullptr;
-    char *addr_ = nullptr;
-    socklen_t addr_len_ = 0;
+    void SetAddress(sockaddr *address, socklen_t addr_len);
+
+private:
+    std::shared_ptr<Buffer> buffer_ = nullptr;
+    RefBuffer::Ref ref_buffer_;
+    int content_size_ = 0;
     ssize_t offset_ = 0;
+    sockaddr_storage addr_{};
+    socklen_t addr_len_ = 0;
+    char inline_data_[kInlineSize];
+    Buffer inline_buffer_;
 };
 
 #endif //BUFFER_SOCK_H
@@ -0,0 +1,72 @@
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * 按字节序读写整数，内部为memcpy加字节交换，编译后为单条load/store(+bswap)
+ */
+class Endian {
+public:
+    template<typename T>
+    static T LoadBig(const char *data) {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return IsLittle() ? Swap(value) : value;
+    }
+
+    template<typename T>
+    static T LoadLittle(const char *data) {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return IsLittle() ? value : Swap(value);
+    }
+
+    template<typename T>
+    static void StoreBig(char *data, T value) {
+        value = IsLittle() ? Swap(value) : value;
+        memcpy(data, &value, sizeof(T));
+    }
+
+    template<typename T>
+    static void StoreLittle(char *data, T value) {
+        value = IsLittle() ? value : Swap(value);
+        memcpy(data, &value, sizeof(T));
+    }
+
+    static constexpr bool IsLittle() {
+        return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+    }
+
+    static uint8_t Swap(uint8_t value) {
+        return value;
+    }
+
+    static uint16_t Swap(uint16_t value) {
+        return __builtin_bswap16(value);
+    }
+
+    static uint32_t Swap(uint32_t value) {
+        return __builtin_bswap32(value);
+    }
+
+    static uint64_t Swap(uint64_t value) {
+        return __builtin_bswap64(value);
+    }
+
+    /**
+     * 有符号整数按对应的无符号类型交换
+     */
+    template<typename T>
+    static typename std::enable_if<std::is_signed<T>::value, T>::type Swap(T value) {
+        using Unsigned = typename std::make_unsigned<T>::type;
+        return static_cast<T>(Swap(static_cast<Unsigned>(value)));
+    }
+
+private:
+    Endian() = default;
+};
+
+#endif //BYTE_ORDER_H
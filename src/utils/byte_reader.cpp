@@ -0,0 +1,69 @@
+#include "byte_reader.h"
+
+static constexpr int kMaxVarintBytes = 10;
+
+ByteReader::ByteReader(const char *data, size_t size)
+        : data_(data), size_(size) {
+}
+
+ByteReader::ByteReader(const Buffer &buffer)
+        : ByteReader(buffer.GetData(), static_cast<size_t>(buffer.GetContentSize())) {
+}
+
+bool ByteReader::Skip(size_t size) {
+    if (!Require(size)) {
+        return false;
+    }
+
+    offset_ += size;
+    return true;
+}
+
+bool ByteReader::ReadVarint(uint64_t &value) {
+    if (!valid_) {
+        return false;
+    }
+
+    uint64_t result = 0;
+    for (int i = 0; i < kMaxVarintBytes && offset_ < size_; ++i) {
+        auto byte = static_cast<uint8_t>(data_[offset_++]);
+        if (i == kMaxVarintBytes - 1 && byte > 1) {
+            // only the lowest bit of the 10th byte fits in 64 bits
+            break;
+        }
+        result |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            value = result;
+            return true;
+        }
+    }
+
+    // truncated, overflowed or longer than 10 bytes
+    valid_ = false;
+    return false;
+}
+
+bool ByteReader::ReadSignedVarint(int64_t &value) {
+    uint64_t encoded;
+    if (!ReadVarint(encoded)) {
+        return false;
+    }
+
+    value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+    return true;
+}
+
+bool ByteReader::ReadBytes(size_t size, StringView &value) {
+    if (!Require(size)) {
+        return false;
+    }
+
+    value = StringView(data_ + offset_, size);
+    offset_ += size;
+    return true;
+}
+
+bool ByteReader::ReadVarintString(StringView &value) {
+    uint64_t length;
+    return ReadVarint(length) && ReadBytes(static_cast<size_t>(length), value);
+}
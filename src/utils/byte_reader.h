@@ -0,0 +1,136 @@
+#ifndef BYTE_READER_H
+#define BYTE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buffer.h"
+#include "byte_order.h"
+#include "string_view.h"
+
+/**
+ * 带边界检查的二进制读取，不拷贝数据，字符串以StringView返回
+ * 任意一次读取越界后IsValid()为false，之后的读取都失败，可以连续读取后统一检查
+ * 长度已知时先Require一次，再使用Unchecked系列接口，省去每个字段的检查
+ */
+class ByteReader {
+public:
+    explicit ByteReader(const char *data, size_t size);
+
+    explicit ByteReader(const Buffer &buffer);
+
+public:
+    bool IsValid() const {
+        return valid_;
+    }
+
+    size_t GetOffset() const {
+        return offset_;
+    }
+
+    size_t GetRemaining() const {
+        return size_ - offset_;
+    }
+
+    const char *GetCurrent() const {
+        return data_ + offset_;
+    }
+
+    /**
+     * 检查剩余数据是否至少有size字节，不足时置为无效
+     */
+    bool Require(size_t size) {
+        if (!valid_ || size > size_ - offset_) {
+            valid_ = false;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Skip(size_t size);
+
+    template<typename T>
+    bool ReadBig(T &value) {
+        if (!Require(sizeof(T))) {
+            return false;
+        }
+
+        value = ReadBigUnchecked<T>();
+        return true;
+    }
+
+    template<typename T>
+    bool ReadLittle(T &value) {
+        if (!Require(sizeof(T))) {
+            return false;
+        }
+
+        value = ReadLittleUnchecked<T>();
+        return true;
+    }
+
+    template<typename T>
+    T ReadBigUnchecked() {
+        auto value = Endian::LoadBig<T>(data_ + offset_);
+        offset_ += sizeof(T);
+        return value;
+    }
+
+    template<typename T>
+    T ReadLittleUnchecked() {
+        auto value = Endian::LoadLittle<T>(data_ + offset_);
+        offset_ += sizeof(T);
+        return value;
+    }
+
+    bool ReadUint8(uint8_t &value) {
+        return ReadBig(value);
+    }
+
+    bool ReadUint16(uint16_t &value) {
+        return ReadBig(value);
+    }
+
+    bool ReadUint32(uint32_t &value) {
+        return ReadBig(value);
+    }
+
+    bool ReadUint64(uint64_t &value) {
+        return ReadBig(value);
+    }
+
+    /**
+     * 读取无符号LEB128变长整数，最多10字节
+     */
+    bool ReadVarint(uint64_t &value);
+
+    /**
+     * 读取zigzag编码的有符号变长整数
+     */
+    bool ReadSignedVarint(int64_t &value);
+
+    bool ReadBytes(size_t size, StringView &value);
+
+    /**
+     * 读取以T类型大端长度为前缀的字符串
+     */
+    template<typename T>
+    bool ReadString(StringView &value) {
+        T length;
+        return ReadBig(length) && ReadBytes(length, value);
+    }
+
+    /**
+     * 读取以变长整数长度为前缀的字符串
+     */
+    bool ReadVarintString(StringView &value);
+
+private:
+    const char *data_;
+    size_t size_;
+    size_t offset_ = 0;
+    bool valid_ = true;
+};
+
+#endif //BYTE_READER_H
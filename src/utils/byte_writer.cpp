@@ -0,0 +1,80 @@
+#include "byte_writer.h"
+
+#include <climits>
+#include <cstring>
+
+static constexpr int kMaxVarintBytes = 10;
+// MutableBuffer sizes are int
+static constexpr size_t kMaxContentSize = INT_MAX;
+
+ByteWriter::ByteWriter(MutableBuffer &buffer)
+        : buffer_(buffer) {
+}
+
+void ByteWriter::WriteVarint(uint64_t value) {
+    if (!Ensure(kMaxVarintBytes)) {
+        return;
+    }
+
+    auto data = buffer_.GetWritableData();
+    int count = 0;
+    while (value >= 0x80) {
+        data[count++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    data[count++] = static_cast<char>(value);
+
+    buffer_.IncreaseContentSize(count);
+}
+
+void ByteWriter::WriteSignedVarint(int64_t value) {
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void ByteWriter::WriteBytes(const char *data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    if (!Ensure(size)) {
+        return;
+    }
+
+    buffer_.AppendData(data, static_cast<int>(size));
+}
+
+void ByteWriter::WriteVarintString(StringView value) {
+    WriteVarint(value.size());
+    WriteBytes(value);
+}
+
+size_t ByteWriter::Reserve(size_t size) {
+    auto offset = GetOffset();
+
+    if (!Ensure(size)) {
+        return offset;
+    }
+
+    memset(buffer_.GetWritableData(), 0, size);
+    buffer_.IncreaseContentSize(static_cast<int>(size));
+
+    return offset;
+}
+
+bool ByteWriter::Grow(size_t size) {
+    auto content_size = static_cast<size_t>(buffer_.GetContentSize());
+    if (size > kMaxContentSize - content_size) {
+        valid_ = false;
+        return false;
+    }
+
+    auto required = content_size + size;
+    auto capacity = static_cast<size_t>(buffer_.GetCapacity());
+    capacity = capacity > kMaxContentSize / 2 ? kMaxContentSize : capacity * 2;
+    if (buffer_.SetCapacity(static_cast<int>(capacity > required ? capacity : required)) != Success) {
+        valid_ = false;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,136 @@
+#ifndef BYTE_WRITER_H
+#define BYTE_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "byte_order.h"
+#include "mutable_buffer.h"
+#include "string_view.h"
+
+/**
+ * 二进制写入，追加到MutableBuffer的内容末尾，容量不足时自动扩容
+ * 长度字段可以先Reserve占位，写完内容后再Patch
+ * 内容超过INT_MAX字节或扩容失败后IsValid()为false，之后的写入都被忽略，可以连续写入后统一检查
+ */
+class ByteWriter {
+public:
+    explicit ByteWriter(MutableBuffer &buffer);
+
+public:
+    bool IsValid() const {
+        return valid_;
+    }
+
+    /**
+     * 已写入内容的总长度，即buffer的内容长度
+     */
+    size_t GetOffset() const {
+        return static_cast<size_t>(buffer_.GetContentSize());
+    }
+
+    /**
+     * 保证可以连续写入size字节，返回true后可以使用Unchecked系列接口，扩容失败时置为无效
+     */
+    bool Ensure(size_t size) {
+        if (!valid_) {
+            return false;
+        }
+
+        if (static_cast<size_t>(buffer_.GetAvailableSpace()) < size) {
+            return Grow(size);
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    void WriteBig(T value) {
+        if (Ensure(sizeof(T))) {
+            WriteBigUnchecked(value);
+        }
+    }
+
+    template<typename T>
+    void WriteLittle(T value) {
+        if (Ensure(sizeof(T))) {
+            WriteLittleUnchecked(value);
+        }
+    }
+
+    template<typename T>
+    void WriteBigUnchecked(T value) {
+        Endian::StoreBig<T>(buffer_.GetWritableData(), value);
+        buffer_.IncreaseContentSize(sizeof(T));
+    }
+
+    template<typename T>
+    void WriteLittleUnchecked(T value) {
+        Endian::StoreLittle<T>(buffer_.GetWritableData(), value);
+        buffer_.IncreaseContentSize(sizeof(T));
+    }
+
+    void WriteUint8(uint8_t value) {
+        WriteBig(value);
+    }
+
+    void WriteUint16(uint16_t value) {
+        WriteBig(value);
+    }
+
+    void WriteUint32(uint32_t value) {
+        WriteBig(value);
+    }
+
+    void WriteUint64(uint64_t value) {
+        WriteBig(value);
+    }
+
+    void WriteVarint(uint64_t value);
+
+    void WriteSignedVarint(int64_t value);
+
+    void WriteBytes(const char *data, size_t size);
+
+    void WriteBytes(StringView value) {
+        WriteBytes(value.data(), value.size());
+    }
+
+    /**
+     * 写入以T类型大端长度为前缀的字符串
+     */
+    template<typename T>
+    void WriteString(StringView value) {
+        WriteBig(static_cast<T>(value.size()));
+        WriteBytes(value);
+    }
+
+    void WriteVarintString(StringView value);
+
+    /**
+     * 预留size字节(填0)，返回其偏移，用于之后Patch长度等字段，无效时不预留
+     */
+    size_t Reserve(size_t size);
+
+    /**
+     * 覆盖写入之前预留位置的大端整数
+     */
+    template<typename T>
+    void PatchBig(size_t offset, T value) {
+        Endian::StoreBig<T>(const_cast<char *>(buffer_.GetData()) + offset, value);
+    }
+
+    template<typename T>
+    void PatchLittle(size_t offset, T value) {
+        Endian::StoreLittle<T>(const_cast<char *>(buffer_.GetData()) + offset, value);
+    }
+
+private:
+    bool Grow(size_t size);
+
+private:
+    MutableBuffer &buffer_;
+    bool valid_ = true;
+};
+
+#endif //BYTE_WRITER_H
@@ -0,0 +1,309 @@
+#include "checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define CHECKSUM_X86 1
+#endif
+
+__extension__ typedef unsigned __int128 uint128;
+
+// reflected Castagnoli polynomial
+static constexpr uint32_t kCrc32cPoly = 0x82F63B78;
+
+// lengths of the interleaved streams, must be powers of two
+static constexpr size_t kLongBlock = 8192;
+static constexpr size_t kShortBlock = 256;
+
+static const uint64_t kHashSecret[4] = {
+        0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+};
+
+struct Crc32cTables {
+    // slicing-by-8 for the software path
+    uint32_t slices[8][256];
+    // multiply a crc by x^(8 * length), to combine the interleaved streams
+    uint32_t long_shift[4][256];
+    uint32_t short_shift[4][256];
+};
+
+static void init_tables(Crc32cTables &tables);
+
+static const Crc32cTables &get_tables() {
+    static Crc32cTables tables;
+    static const bool initialized = (init_tables(tables), true);
+    (void) initialized;
+
+    return tables;
+}
+
+static uint32_t gf2_matrix_times(const uint32_t *matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    while (vector) {
+        if (vector & 1) {
+            sum ^= *matrix;
+        }
+        vector >>= 1;
+        ++matrix;
+    }
+
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t *square, const uint32_t *matrix) {
+    for (int n = 0; n < 32; ++n) {
+        square[n] = gf2_matrix_times(matrix, matrix[n]);
+    }
+}
+
+// operator that appends length zero bytes to a crc, length must be a power of two
+static void make_zeros_operator(uint32_t *even, size_t length) {
+    uint32_t odd[32];
+
+    // one zero bit
+    odd[0] = kCrc32cPoly;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    // two and four zero bits, the first square in the loop gives one zero byte
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+
+    do {
+        gf2_matrix_square(even, odd);
+        length >>= 1;
+        if (length == 0) {
+            return;
+        }
+
+        gf2_matrix_square(odd, even);
+        length >>= 1;
+    } while (length);
+
+    memcpy(even, odd, sizeof(odd));
+}
+
+static void make_shift_table(uint32_t table[4][256], size_t length) {
+    uint32_t op[32];
+    make_zeros_operator(op, length);
+
+    for (uint32_t n = 0; n < 256; ++n) {
+        table[0][n] = gf2_matrix_times(op, n);
+        table[1][n] = gf2_matrix_times(op, n << 8);
+        table[2][n] = gf2_matrix_times(op, n << 16);
+        table[3][n] = gf2_matrix_times(op, n << 24);
+    }
+}
+
+void init_tables(Crc32cTables &tables) {
+    auto &slices = tables.slices;
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; ++k) {
+            crc = crc & 1 ? (crc >> 1) ^ kCrc32cPoly : crc >> 1;
+        }
+        slices[0][n] = crc;
+    }
+
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t crc = slices[0][n];
+        for (int k = 1; k < 8; ++k) {
+            crc = slices[0][crc & 0xFF] ^ (crc >> 8);
+            slices[k][n] = crc;
+        }
+    }
+
+    make_shift_table(tables.long_shift, kLongBlock);
+    make_shift_table(tables.short_shift, kShortBlock);
+}
+
+static uint32_t crc32c_shift(const uint32_t table[4][256], uint32_t crc) {
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+}
+
+static uint64_t load64(const uint8_t *data) {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t crc32c_software(uint32_t crc, const uint8_t *data, size_t size) {
+    auto &tables = get_tables();
+    auto &slices = tables.slices;
+
+    while (size >= 8) {
+        // little endian only, the same as the rest of the fast paths
+        uint64_t value = load64(data) ^ crc;
+        crc = slices[7][value & 0xFF] ^ slices[6][(value >> 8) & 0xFF] ^
+              slices[5][(value >> 16) & 0xFF] ^ slices[4][(value >> 24) & 0xFF] ^
+              slices[3][(value >> 32) & 0xFF] ^ slices[2][(value >> 40) & 0xFF] ^
+              slices[1][(value >> 48) & 0xFF] ^ slices[0][value >> 56];
+        data += 8;
+        size -= 8;
+    }
+
+    while (size > 0) {
+        crc = slices[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        --size;
+    }
+
+    return crc;
+}
+
+#ifdef CHECKSUM_X86
+
+static bool has_sse42() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+
+// three independent crc32 chains hide the latency of the instruction, then the crcs are combined
+__attribute__((target("sse4.2")))
+static uint64_t crc32c_interleaved(uint64_t crc, const uint8_t *&data, size_t &size, size_t block,
+                                   const uint32_t shift[4][256]) {
+    while (size >= block * 3) {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        auto end = data + block;
+        do {
+            crc = _mm_crc32_u64(crc, load64(data));
+            crc1 = _mm_crc32_u64(crc1, load64(data + block));
+            crc2 = _mm_crc32_u64(crc2, load64(data + block * 2));
+            data += 8;
+        } while (data < end);
+
+        crc = crc32c_shift(shift, static_cast<uint32_t>(crc)) ^ crc1;
+        crc = crc32c_shift(shift, static_cast<uint32_t>(crc)) ^ crc2;
+        data += block * 2;
+        size -= block * 3;
+    }
+
+    return crc;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hardware(uint32_t crc, const uint8_t *data, size_t size) {
+    while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        --size;
+    }
+
+    auto &tables = get_tables();
+    uint64_t crc64 = crc;
+    crc64 = crc32c_interleaved(crc64, data, size, kLongBlock, tables.long_shift);
+    crc64 = crc32c_interleaved(crc64, data, size, kShortBlock, tables.short_shift);
+
+    while (size >= 8) {
+        crc64 = _mm_crc32_u64(crc64, load64(data));
+        data += 8;
+        size -= 8;
+    }
+
+    crc = static_cast<uint32_t>(crc64);
+    while (size > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        --size;
+    }
+
+    return crc;
+}
+
+#endif
+
+uint32_t Checksum::Crc32c(const char *data, size_t size, uint32_t crc) {
+    auto input = reinterpret_cast<const uint8_t *>(data);
+    crc = ~crc;
+
+#ifdef CHECKSUM_X86
+    if (has_sse42()) {
+        return ~crc32c_hardware(crc, input, size);
+    }
+#endif
+
+    return ~crc32c_software(crc, input, size);
+}
+
+bool Checksum::IsCrc32cAccelerated() {
+#ifdef CHECKSUM_X86
+    return has_sse42();
+#else
+    return false;
+#endif
+}
+
+static void multiply(uint64_t &a, uint64_t &b) {
+    uint128 result = a;
+    result *= b;
+    a = static_cast<uint64_t>(result);
+    b = static_cast<uint64_t>(result >> 64);
+}
+
+static uint64_t mix(uint64_t a, uint64_t b) {
+    multiply(a, b);
+    return a ^ b;
+}
+
+static uint64_t load32(const uint8_t *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint64_t load_small(const uint8_t *data, size_t size) {
+    return (static_cast<uint64_t>(data[0]) << 16) | (static_cast<uint64_t>(data[size >> 1]) << 8) | data[size - 1];
+}
+
+uint64_t Checksum::Hash64(const char *data, size_t size, uint64_t seed) {
+    auto p = reinterpret_cast<const uint8_t *>(data);
+    auto &secret = kHashSecret;
+
+    seed ^= mix(seed ^ secret[0], secret[1]);
+
+    uint64_t a;
+    uint64_t b;
+    if (size <= 16) {
+        if (size >= 4) {
+            a = (load32(p) << 32) | load32(p + ((size >> 3) << 2));
+            b = (load32(p + size - 4) << 32) | load32(p + size - 4 - ((size >> 3) << 2));
+        } else if (size > 0) {
+            a = load_small(p, size);
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        auto remaining = size;
+        if (remaining > 48) {
+            auto seed1 = seed;
+            auto seed2 = seed;
+            do {
+                seed = mix(load64(p) ^ secret[1], load64(p + 8) ^ seed);
+                seed1 = mix(load64(p + 16) ^ secret[2], load64(p + 24) ^ seed1);
+                seed2 = mix(load64(p + 32) ^ secret[3], load64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16) {
+            seed = mix(load64(p) ^ secret[1], load64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        a = load64(p + remaining - 16);
+        b = load64(p + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    multiply(a, b);
+
+    return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
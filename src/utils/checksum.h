@@ -0,0 +1,48 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buffer.h"
+#include "string_view.h"
+
+/**
+ * 校验和与非加密哈希
+ */
+class Checksum {
+public:
+    /**
+     * CRC32C(Castagnoli)，支持增量计算: 将上一次的结果作为crc传入，初始为0
+     * 支持SSE4.2时使用crc32指令并三路交错计算，否则使用slicing-by-8查表
+     */
+    static uint32_t Crc32c(const char *data, size_t size, uint32_t crc = 0);
+
+    static uint32_t Crc32c(const Buffer &buffer, uint32_t crc = 0) {
+        return Crc32c(buffer.GetData(), static_cast<size_t>(buffer.GetContentSize()), crc);
+    }
+
+    static uint32_t Crc32c(StringView data, uint32_t crc = 0) {
+        return Crc32c(data.data(), data.size(), crc);
+    }
+
+    /**
+     * 64位快速哈希(wyhash算法)，用于哈希表和按哈希路由，不能用于安全相关场景
+     */
+    static uint64_t Hash64(const char *data, size_t size, uint64_t seed = 0);
+
+    static uint64_t Hash64(const Buffer &buffer, uint64_t seed = 0) {
+        return Hash64(buffer.GetData(), static_cast<size_t>(buffer.GetContentSize()), seed);
+    }
+
+    static uint64_t Hash64(StringView data, uint64_t seed = 0) {
+        return Hash64(data.data(), data.size(), seed);
+    }
+
+    /**
+     * 是否使用了crc32指令
+     */
+    static bool IsCrc32cAccelerated();
+};
+
+#endif //CHECKSUM_H
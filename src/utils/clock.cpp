@@ -0,0 +1,220 @@
+#include "clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#if defined(__x86_64__)
+
+#include <cpuid.h>
+#include <x86intrin.h>
+
+#endif
+
+static constexpr int64_t kNanosecondsPerSecond = 1000000000;
+static constexpr int64_t kTscCalibrateNanoseconds = 10 * 1000 * 1000;
+static constexpr int64_t kTscRecalibrateNanoseconds = kNanosecondsPerSecond;
+static constexpr int kTscShift = 32;
+
+__extension__ typedef unsigned __int128 uint128;
+__extension__ typedef __int128 int128;
+
+// released after the tsc parameters were published by the first SetSource(Tsc)
+static std::atomic<int> clock_source{static_cast<int>(ClockSource::Monotonic)};
+
+static std::once_flag tsc_calibrate_flag;
+static bool tsc_calibrated = false;
+
+// tsc -> ns parameters, written under tsc_mutex and read through the tsc_sequence seqlock
+static std::atomic<uint32_t> tsc_sequence{0};
+static std::atomic<uint64_t> tsc_base{0};
+static std::atomic<int64_t> tsc_base_ns{0};
+static std::atomic<uint64_t> tsc_mult{0};
+static std::atomic<uint64_t> tsc_recalibrate_ticks{0};
+
+// the last pair read together from the tsc and CLOCK_MONOTONIC, only used under tsc_mutex
+static std::mutex tsc_mutex;
+static uint64_t tsc_anchor = 0;
+static int64_t tsc_anchor_ns = 0;
+
+static int64_t get_clock_nanoseconds(clockid_t clock_id) {
+    timespec ts{};
+    clock_gettime(clock_id, &ts);
+    return ts.tv_sec * kNanosecondsPerSecond + ts.tv_nsec;
+}
+
+static uint64_t read_tsc() {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+int64_t Clock::Now() {
+    switch (static_cast<ClockSource>(clock_source.load(std::memory_order_acquire))) {
+        case ClockSource::MonotonicCoarse:
+            return GetCoarseNanoseconds();
+        case ClockSource::Tsc:
+            return GetTscNanoseconds();
+        default:
+            return GetMonotonicNanoseconds();
+    }
+}
+
+int64_t Clock::GetMonotonicNanoseconds() {
+    return get_clock_nanoseconds(CLOCK_MONOTONIC);
+}
+
+int64_t Clock::GetCoarseNanoseconds() {
+    return get_clock_nanoseconds(CLOCK_MONOTONIC_COARSE);
+}
+
+bool Clock::SetSource(ClockSource source) {
+    if (source == ClockSource::Tsc) {
+        std::call_once(tsc_calibrate_flag, []() {
+            tsc_calibrated = IsTscReliable() && CalibrateTsc();
+        });
+        if (!tsc_calibrated) {
+            return false;
+        }
+    }
+
+    clock_source.store(static_cast<int>(source), std::memory_order_release);
+    return true;
+}
+
+ClockSource Clock::GetSource() {
+    return static_cast<ClockSource>(clock_source.load(std::memory_order_acquire));
+}
+
+bool Clock::IsTscReliable() {
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return false;
+    }
+
+    // invariant tsc: constant rate in all p-/c-states
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    if (!(edx & (1u << 8))) {
+        return false;
+    }
+
+    // the kernel drops tsc as clock source when it found it unsynchronized between cpus
+    std::ifstream stream("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    std::string current;
+    if (stream.is_open() && std::getline(stream, current)) {
+        return current == "tsc";
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+int64_t Clock::GetTscNanoseconds() {
+    uint32_t sequence;
+    uint64_t base;
+    int64_t base_ns;
+    uint64_t mult;
+    uint64_t tsc;
+    do {
+        sequence = tsc_sequence.load(std::memory_order_acquire);
+        base = tsc_base.load(std::memory_order_relaxed);
+        base_ns = tsc_base_ns.load(std::memory_order_relaxed);
+        mult = tsc_mult.load(std::memory_order_relaxed);
+        tsc = read_tsc();
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != tsc_sequence.load(std::memory_order_relaxed));
+
+    // may be read before another thread published a newer base
+    auto delta = static_cast<int64_t>(tsc - base);
+    auto now_ns = base_ns + static_cast<int64_t>((static_cast<int128>(delta) * mult) >> kTscShift);
+
+    if (delta > static_cast<int64_t>(tsc_recalibrate_ticks.load(std::memory_order_relaxed))) {
+        RecalibrateTsc();
+    }
+
+    return now_ns;
+}
+
+bool Clock::CalibrateTsc() {
+    auto start_ns = GetMonotonicNanoseconds();
+    auto start_tsc = read_tsc();
+
+    int64_t end_ns;
+    do {
+        end_ns = GetMonotonicNanoseconds();
+    } while (end_ns - start_ns < kTscCalibrateNanoseconds);
+    auto end_tsc = read_tsc();
+
+    if (end_tsc <= start_tsc) {
+        return false;
+    }
+
+    auto mult = (static_cast<uint64_t>(end_ns - start_ns) << kTscShift) / (end_tsc - start_tsc);
+    if (mult == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(tsc_mutex);
+    tsc_anchor = end_tsc;
+    tsc_anchor_ns = end_ns;
+    PublishTsc(end_tsc, end_ns, mult);
+    return true;
+}
+
+void Clock::RecalibrateTsc() {
+    // one caller recalibrates, the others keep using the current parameters
+    std::unique_lock<std::mutex> lock(tsc_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+
+    auto now_tsc = read_tsc();
+    auto now_ns = GetMonotonicNanoseconds();
+    auto base = tsc_base.load(std::memory_order_relaxed);
+    if (static_cast<int64_t>(now_tsc - base) <= static_cast<int64_t>(tsc_recalibrate_ticks.load(std::memory_order_relaxed))) {
+        // recalibrated by another caller in the meantime
+        return;
+    }
+
+    if (now_tsc <= tsc_anchor || now_ns <= tsc_anchor_ns) {
+        return;
+    }
+
+    // the rate measured since the last anchor, over about a second it is far more precise than the first 10ms
+    auto mult = (static_cast<uint128>(now_ns - tsc_anchor_ns) << kTscShift) / (now_tsc - tsc_anchor);
+
+    // continue from the current tsc time so it never jumps backwards, and slew the rate so the
+    // offset to CLOCK_MONOTONIC is gone by the next recalibration, the drift stays bounded
+    auto tsc_ns = tsc_base_ns.load(std::memory_order_relaxed) +
+                  static_cast<int64_t>((static_cast<int128>(now_tsc - base) *
+                                        tsc_mult.load(std::memory_order_relaxed)) >> kTscShift);
+    auto offset_ns = std::max(-kTscRecalibrateNanoseconds / 2,
+                              std::min(kTscRecalibrateNanoseconds / 2, tsc_ns - now_ns));
+    mult = mult * static_cast<uint128>(kTscRecalibrateNanoseconds - offset_ns) / kTscRecalibrateNanoseconds;
+
+    tsc_anchor = now_tsc;
+    tsc_anchor_ns = now_ns;
+    PublishTsc(now_tsc, tsc_ns, static_cast<uint64_t>(mult));
+}
+
+void Clock::PublishTsc(uint64_t base, int64_t base_ns, uint64_t mult) {
+    auto sequence = tsc_sequence.load(std::memory_order_relaxed);
+    tsc_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    tsc_base.store(base, std::memory_order_relaxed);
+    tsc_base_ns.store(base_ns, std::memory_order_relaxed);
+    tsc_mult.store(mult, std::memory_order_relaxed);
+    tsc_recalibrate_ticks.store(static_cast<uint64_t>(
+            (static_cast<uint128>(kTscRecalibrateNanoseconds) << kTscShift) / mult), std::memory_order_relaxed);
+
+    tsc_sequence.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,52 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+enum class ClockSource {
+    Monotonic,
+    MonotonicCoarse,
+    Tsc,
+};
+
+/**
+ * 进程级单调时钟，单位纳秒，所有时钟源使用CLOCK_MONOTONIC的时间基准
+ */
+class Clock {
+public:
+    /**
+     * 按当前时钟源获取时间
+     */
+    static int64_t Now();
+
+    static int64_t GetMonotonicNanoseconds();
+
+    /**
+     * CLOCK_MONOTONIC_COARSE，精度为一个jiffy(通常1~4ms)
+     */
+    static int64_t GetCoarseNanoseconds();
+
+    /**
+     * 切换时钟源，Tsc需要cpu支持invariant tsc并且内核时钟源也为tsc，不满足时返回false并保持原时钟源
+     * 首次切换到Tsc时以CLOCK_MONOTONIC校准，约阻塞10ms
+     * 之后大约每秒由调用Now的线程重新校准一次，调整速率使与CLOCK_MONOTONIC的偏差在下次校准前消除，不会回退
+     */
+    static bool SetSource(ClockSource source);
+
+    static ClockSource GetSource();
+
+    static bool IsTscReliable();
+
+private:
+    Clock() = default;
+
+    static int64_t GetTscNanoseconds();
+
+    static bool CalibrateTsc();
+
+    static void RecalibrateTsc();
+
+    static void PublishTsc(uint64_t base, int64_t base_ns, uint64_t mult);
+};
+
+#endif //CLOCK_H
@@ -2,10 +2,14 @@
 
 #include <cstring>
 
+#include "buffer_pool.h"
+
 CopyBuffer::CopyBuffer(const char *data, int size)
-        : buffer_(new char[size + 1]), size_(size) {
-    memset(buffer_, 0, size_ + 1);
-    memcpy(buffer_, data, size_);
+        : buffer_(BufferPool::GetInstance()->Allocate(size + 1)), size_(size) {
+    if (data && size_ > 0) {
+        memcpy(buffer_, data, size_);
+    }
+    buffer_[size_] = 0;
 }
 
 CopyBuffer::CopyBuffer(Buffer::Ptr &data)
@@ -13,13 +17,25 @@ CopyBuffer::CopyBuffer(Buffer::Ptr &data)
 }
 
 CopyBuffer::~CopyBuffer() {
-    delete[] buffer_;
+    BufferPool::GetInstance()->Deallocate(buffer_, size_ + 1);
+}
+
+CopyBuffer::Ptr CopyBuffer::Create(const char *data, int size) {
+    return std::allocate_shared<CopyBuffer>(BufferPoolAllocator<CopyBuffer>(), data, size);
 }
 
 const char *CopyBuffer::GetData() const {
     return buffer_;
 }
 
+char *CopyBuffer::GetWritableData() {
+    return buffer_;
+}
+
 int CopyBuffer::GetContentSize() const {
     return size_;
 }
+
+bool CopyBuffer::IsRetainable() const {
+    return true;
+}
@@ -18,11 +18,21 @@ public:
 
     ~CopyBuffer() override;
 
+    /**
+     * 对象和数据都从BufferPool分配
+     * data为空时只分配不拷贝，由创建者在共享之前通过GetWritableData填充
+     */
+    static Ptr Create(const char *data, int size);
+
 public:
     const char *GetData() const override;
 
+    char *GetWritableData();
+
     int GetContentSize() const override;
 
+    bool IsRetainable() const override;
+
 private:
     char *buffer_;
     int size_;
@@ -0,0 +1,161 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sched.h>
+#include <set>
+#include <thread>
+
+static bool read_file(const std::string &path, std::string &content) {
+    std::ifstream stream(path);
+    if (!stream.is_open()) {
+        return false;
+    }
+
+    std::getline(stream, content);
+    return true;
+}
+
+std::vector<int> CpuTopology::GetAvailableCpus() {
+    std::vector<int> cpus;
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpu_set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+
+    if (cpus.empty()) {
+        int count = static_cast<int>(std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+std::vector<int> CpuTopology::GetPhysicalCoreCpus(const std::vector<int> &cpus) {
+    std::vector<int> result;
+    std::set<std::string> cores;
+
+    for (auto cpu: cpus) {
+        std::string siblings;
+        auto path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list";
+        if (!read_file(path, siblings)) {
+            // the topology was unknown, treat every cpu as a physical core
+            siblings = std::to_string(cpu);
+        }
+
+        if (cores.insert(siblings).second) {
+            result.push_back(cpu);
+        }
+    }
+
+    return result;
+}
+
+std::vector<int> CpuTopology::Exclude(const std::vector<int> &cpus, const std::vector<int> &excluded) {
+    std::vector<int> result;
+    for (auto cpu: cpus) {
+        if (std::find(excluded.begin(), excluded.end(), cpu) == excluded.end()) {
+            result.push_back(cpu);
+        }
+    }
+
+    return result;
+}
+
+int CpuTopology::GetNumaNodeCount() {
+    std::string online;
+    std::vector<int> nodes;
+    if (!read_file("/sys/devices/system/node/online", online) || !ParseCpuList(online, nodes) || nodes.empty()) {
+        return 1;
+    }
+
+    return nodes.back() + 1;
+}
+
+int CpuTopology::GetNumaNodeOfCpu(int cpu) {
+    auto count = GetNumaNodeCount();
+    for (int node = 0; node < count; ++node) {
+        auto cpus = GetNumaNodeCpus(node);
+        if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+            return node;
+        }
+    }
+
+    return -1;
+}
+
+int CpuTopology::GetNumaNodeOfCpus(const std::vector<int> &cpus) {
+    int result = -1;
+    for (auto cpu: cpus) {
+        auto node = GetNumaNodeOfCpu(cpu);
+        if (node < 0 || (result >= 0 && node != result)) {
+            return -1;
+        }
+        result = node;
+    }
+
+    return result;
+}
+
+std::vector<int> CpuTopology::GetNumaNodeCpus(int node) {
+    std::string content;
+    std::vector<int> cpus;
+    auto path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+    if (!read_file(path, content) || !ParseCpuList(content, cpus)) {
+        cpus.clear();
+    }
+
+    return cpus;
+}
+
+bool CpuTopology::ParseCpuList(const std::string &data, std::vector<int> &cpus) {
+    cpus.clear();
+
+    size_t position = 0;
+    while (position < data.size()) {
+        auto end = data.find(',', position);
+        if (end == std::string::npos) {
+            end = data.size();
+        }
+
+        auto item = data.substr(position, end - position);
+        position = end + 1;
+        if (item.empty() || item == "\n") {
+            continue;
+        }
+
+        char *next = nullptr;
+        long first = strtol(item.c_str(), &next, 10);
+        long last = first;
+        if (next == item.c_str()) {
+            return false;
+        }
+
+        if (*next == '-') {
+            const char *range = next + 1;
+            last = strtol(range, &next, 10);
+            if (next == range) {
+                return false;
+            }
+        }
+
+        if (first < 0 || last < first) {
+            return false;
+        }
+
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+class CpuTopology {
+public:
+    /**
+     * 获取当前进程可以运行的cpu列表(受taskset/cgroup限制)
+     */
+    static std::vector<int> GetAvailableCpus();
+
+    /**
+     * 每个物理核只保留一个cpu，跳过超线程的兄弟cpu
+     * @param cpus 候选cpu列表
+     * @return 物理核cpu列表
+     */
+    static std::vector<int> GetPhysicalCoreCpus(const std::vector<int> &cpus);
+
+    /**
+     * 从cpu列表中排除指定的cpu
+     */
+    static std::vector<int> Exclude(const std::vector<int> &cpus, const std::vector<int> &excluded);
+
+    /**
+     * 获取numa节点个数，不支持numa时返回1
+     */
+    static int GetNumaNodeCount();
+
+    /**
+     * 获取cpu所在的numa节点，未知时返回-1
+     */
+    static int GetNumaNodeOfCpu(int cpu);
+
+    /**
+     * 获取cpu列表所在的numa节点，跨多个节点或者未知时返回-1
+     */
+    static int GetNumaNodeOfCpus(const std::vector<int> &cpus);
+
+    /**
+     * 获取numa节点上的cpu列表
+     */
+    static std::vector<int> GetNumaNodeCpus(int node);
+
+    /**
+     * 解析内核格式的cpu列表，例如 "0-3,8,10-11"
+     */
+    static bool ParseCpuList(const std::string &data, std::vector<int> &cpus);
+
+private:
+    CpuTopology() = default;
+};
+
+#endif //CPU_TOPOLOGY_H
@@ -0,0 +1,177 @@
+#include "memory_allocator.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "spdlog/spdlog.h"
+
+static constexpr int kMemPolicyDefault = 0;
+static constexpr int kMemPolicyPreferred = 1;
+static constexpr int kMemPolicyBind = 2;
+static constexpr int kMaxNumaNodes = 1024;
+static constexpr int kBitsPerMask = 8 * sizeof(unsigned long);
+static constexpr size_t kDefaultHugePageSize = 2 * 1024 * 1024;
+
+static size_t round_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// map size bytes aligned to alignment, so that transparent huge pages can back the whole range
+static void *map_aligned(size_t size, size_t alignment) {
+    auto data = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        return data;
+    }
+
+    auto begin = reinterpret_cast<uintptr_t>(data);
+    auto aligned = round_up(begin, alignment);
+    if (aligned > begin) {
+        munmap(data, aligned - begin);
+    }
+
+    auto tail = begin + size + alignment - (aligned + size);
+    if (tail > 0) {
+        munmap(reinterpret_cast<void *>(aligned + size), tail);
+    }
+
+    return reinterpret_cast<void *>(aligned);
+}
+
+MemoryAllocator::~MemoryAllocator() = default;
+
+PageAllocator::PageAllocator(int numa_node) {
+    options_.numa_node = numa_node;
+}
+
+PageAllocator::PageAllocator(PageAllocatorOptions options)
+        : options_(options) {
+}
+
+PageAllocator::~PageAllocator() = default;
+
+char *PageAllocator::Allocate(size_t size) {
+    size = RoundUp(size);
+
+    void *data = MAP_FAILED;
+    if (options_.huge_pages == HugePageMode::Reserved) {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+
+    if (data == MAP_FAILED) {
+        if (options_.huge_pages == HugePageMode::None) {
+            data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        } else {
+            data = map_aligned(size, GetHugePageSize());
+            if (data != MAP_FAILED) {
+                madvise(data, size, MADV_HUGEPAGE);
+            }
+        }
+    }
+
+    if (data == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    if (options_.numa_node >= 0) {
+        // the pages were not touched yet, so they will be faulted in on the node
+        BindNumaNode(data, size, options_.numa_node);
+    }
+
+    if (options_.prefault) {
+        auto page_size = GetPageSize();
+        auto pages = static_cast<volatile char *>(data);
+        for (size_t offset = 0; offset < size; offset += page_size) {
+            pages[offset] = 0;
+        }
+    }
+
+    if (options_.lock && mlock(data, size) != 0) {
+        // usually RLIMIT_MEMLOCK, the memory is still usable but may be swapped out
+        auto error = errno;
+        SPDLOG_WARN("mlock {} bytes failed with error {}, description '{}'", size, error, strerror(error));
+    }
+
+    return static_cast<char *>(data);
+}
+
+void PageAllocator::Deallocate(char *data, size_t size) {
+    if (data) {
+        munmap(data, RoundUp(size));
+    }
+}
+
+int PageAllocator::GetNumaNode() const {
+    return options_.numa_node;
+}
+
+bool PageAllocator::BindNumaNode(void *data, size_t size, int numa_node) {
+#ifdef SYS_mbind
+    if (numa_node < 0 || numa_node >= kMaxNumaNodes) {
+        return false;
+    }
+
+    unsigned long node_mask[kMaxNumaNodes / kBitsPerMask] = {0};
+    node_mask[numa_node / kBitsPerMask] = 1UL << (numa_node % kBitsPerMask);
+
+    return syscall(SYS_mbind, data, size, kMemPolicyBind, node_mask, kMaxNumaNodes + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+bool PageAllocator::SetPreferredNumaNode(int numa_node) {
+#ifdef SYS_set_mempolicy
+    if (numa_node < 0) {
+        return syscall(SYS_set_mempolicy, kMemPolicyDefault, nullptr, 0) == 0;
+    }
+
+    if (numa_node >= kMaxNumaNodes) {
+        return false;
+    }
+
+    unsigned long node_mask[kMaxNumaNodes / kBitsPerMask] = {0};
+    node_mask[numa_node / kBitsPerMask] = 1UL << (numa_node % kBitsPerMask);
+
+    return syscall(SYS_set_mempolicy, kMemPolicyPreferred, node_mask, kMaxNumaNodes + 1) == 0;
+#else
+    return false;
+#endif
+}
+
+size_t PageAllocator::GetPageSize() {
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+size_t PageAllocator::GetHugePageSize() {
+    static const size_t huge_page_size = []() {
+        std::ifstream stream("/proc/meminfo");
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (line.compare(0, 13, "Hugepagesize:") == 0) {
+                auto size = std::strtoul(line.c_str() + 13, nullptr, 10) * 1024;
+                return size > 0 ? static_cast<size_t>(size) : kDefaultHugePageSize;
+            }
+        }
+
+        return kDefaultHugePageSize;
+    }();
+
+    return huge_page_size;
+}
+
+size_t PageAllocator::RoundUp(size_t size) const {
+    if (options_.huge_pages == HugePageMode::None) {
+        return round_up(size, GetPageSize());
+    }
+
+    return round_up(size, GetHugePageSize());
+}
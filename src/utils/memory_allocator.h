@@ -0,0 +1,84 @@
+#ifndef MEMORY_ALLOCATOR_H
+#define MEMORY_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+
+class MemoryAllocator {
+public:
+    using Ptr = std::shared_ptr<MemoryAllocator>;
+
+    virtual ~MemoryAllocator();
+
+public:
+    virtual char *Allocate(size_t size) = 0;
+
+    virtual void Deallocate(char *data, size_t size) = 0;
+};
+
+enum class HugePageMode {
+    None,
+    // 透明大页，按大页对齐后madvise(MADV_HUGEPAGE)，由内核尽量使用大页
+    Transparent,
+    // 预留的大页(MAP_HUGETLB)，需要配置vm.nr_hugepages，失败时回退为透明大页
+    Reserved,
+};
+
+struct PageAllocatorOptions {
+    // 绑定的numa节点，-1时不绑定
+    int numa_node = -1;
+    // 大页模式，使用大页时分配大小按大页取整
+    HugePageMode huge_pages = HugePageMode::None;
+    // 分配时写入每一页，避免使用时缺页
+    bool prefault = false;
+    // mlock锁定内存，避免被换出
+    bool lock = false;
+};
+
+/**
+ * 按页分配内存，可以绑定到指定的numa节点、使用大页和预先缺页
+ * 适用于长期存在的大块内存，例如poll线程的共享读缓存
+ */
+class PageAllocator : public MemoryAllocator {
+public:
+    explicit PageAllocator(int numa_node = -1);
+
+    explicit PageAllocator(PageAllocatorOptions options);
+
+    ~PageAllocator() override;
+
+public:
+    char *Allocate(size_t size) override;
+
+    void Deallocate(char *data, size_t size) override;
+
+    int GetNumaNode() const;
+
+    /**
+     * 将内存绑定到numa节点
+     * @return 是否成功
+     */
+    static bool BindNumaNode(void *data, size_t size, int numa_node);
+
+    /**
+     * 设置当前线程优先从numa节点分配内存
+     * @param numa_node numa节点，-1时恢复默认策略
+     * @return 是否成功
+     */
+    static bool SetPreferredNumaNode(int numa_node);
+
+    static size_t GetPageSize();
+
+    /**
+     * 获取默认大页大小，读取失败时返回2M
+     */
+    static size_t GetHugePageSize();
+
+private:
+    size_t RoundUp(size_t size) const;
+
+private:
+    PageAllocatorOptions options_;
+};
+
+#endif //MEMORY_ALLOCATOR_H
@@ -0,0 +1,212 @@
+#include "mmap_buffer.h"
+
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "memory_allocator.h"
+
+static int64_t get_modify_time(const struct stat &file_stat) {
+    return static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + file_stat.st_mtim.tv_nsec;
+}
+
+ErrorCode MmapBuffer::Create(const std::string &path, Ptr &buffer, size_t offset, size_t length) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return File_Open_Failed;
+    }
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        close(fd);
+        return File_Open_Failed;
+    }
+
+    auto file_size = static_cast<size_t>(file_stat.st_size);
+    offset = offset < file_size ? offset : file_size;
+    if (length == 0 || length > file_size - offset) {
+        length = file_size - offset;
+    }
+
+    // Buffer reports its size as int
+    if (length > static_cast<size_t>(INT_MAX)) {
+        close(fd);
+        return File_Too_Large;
+    }
+
+    buffer.reset(new MmapBuffer());
+    buffer->path_ = path;
+    buffer->modify_time_ = get_modify_time(file_stat);
+
+    if (length > 0) {
+        // mmap needs a page aligned offset, the data pointer skips the head
+        auto page_offset = offset / PageAllocator::GetPageSize() * PageAllocator::GetPageSize();
+        auto map_size = length + (offset - page_offset);
+        auto data = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(page_offset));
+        if (data == MAP_FAILED) {
+            close(fd);
+            buffer.reset();
+            return File_Map_Failed;
+        }
+
+        buffer->map_data_ = static_cast<char *>(data);
+        buffer->map_size_ = map_size;
+        buffer->data_ = buffer->map_data_ + (offset - page_offset);
+        buffer->size_ = length;
+    }
+
+    close(fd);
+
+    return Success;
+}
+
+MmapBuffer::~MmapBuffer() {
+    if (map_data_) {
+        munmap(map_data_, map_size_);
+    }
+}
+
+const char *MmapBuffer::GetData() const {
+    return data_;
+}
+
+int MmapBuffer::GetContentSize() const {
+    return static_cast<int>(size_);
+}
+
+size_t MmapBuffer::GetSize() const {
+    return size_;
+}
+
+bool MmapBuffer::IsRetainable() const {
+    return true;
+}
+
+bool MmapBuffer::Advise(MmapAdvice advice) {
+    if (map_data_ == nullptr) {
+        return true;
+    }
+
+    int flag;
+    switch (advice) {
+        case MmapAdvice::Sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case MmapAdvice::Random:
+            flag = MADV_RANDOM;
+            break;
+        case MmapAdvice::WillNeed:
+            flag = MADV_WILLNEED;
+            break;
+        default:
+            flag = MADV_NORMAL;
+            break;
+    }
+
+    return madvise(map_data_, map_size_, flag) == 0;
+}
+
+const std::string &MmapBuffer::GetPath() const {
+    return path_;
+}
+
+int64_t MmapBuffer::GetModifyTime() const {
+    return modify_time_;
+}
+
+MmapBufferCache::MmapBufferCache(size_t max_count, size_t max_bytes)
+        : max_count_(max_count), max_bytes_(max_bytes) {
+}
+
+MmapBufferCache::~MmapBufferCache() = default;
+
+ErrorCode MmapBufferCache::Get(const std::string &path, MmapBuffer::Ptr &buffer) {
+    struct stat file_stat{};
+    if (stat(path.c_str(), &file_stat) != 0) {
+        Remove(path);
+        return File_Open_Failed;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = buffer_map_.find(path);
+        if (it != buffer_map_.end()) {
+            auto &cached = *it->second;
+            if (cached->GetModifyTime() == get_modify_time(file_stat) &&
+                cached->GetSize() == static_cast<size_t>(file_stat.st_size)) {
+                lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+                buffer = cached;
+                return Success;
+            }
+
+            bytes_ -= cached->GetSize();
+            lru_list_.erase(it->second);
+            buffer_map_.erase(it);
+        }
+    }
+
+    // map outside the lock, a concurrent Get of the same file may map it twice but only one stays cached
+    MmapBuffer::Ptr mapped;
+    auto result = MmapBuffer::Create(path, mapped);
+    if (result != Success) {
+        return result;
+    }
+    mapped->Advise(MmapAdvice::WillNeed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buffer_map_.find(path);
+    if (it != buffer_map_.end()) {
+        bytes_ -= (*it->second)->GetSize();
+        lru_list_.erase(it->second);
+        buffer_map_.erase(it);
+    }
+
+    lru_list_.push_front(mapped);
+    buffer_map_[path] = lru_list_.begin();
+    bytes_ += mapped->GetSize();
+    Evict();
+
+    buffer = mapped;
+    return Success;
+}
+
+void MmapBufferCache::Remove(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buffer_map_.find(path);
+    if (it == buffer_map_.end()) {
+        return;
+    }
+
+    bytes_ -= (*it->second)->GetSize();
+    lru_list_.erase(it->second);
+    buffer_map_.erase(it);
+}
+
+void MmapBufferCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_list_.clear();
+    buffer_map_.clear();
+    bytes_ = 0;
+}
+
+size_t MmapBufferCache::GetCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_list_.size();
+}
+
+size_t MmapBufferCache::GetBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+void MmapBufferCache::Evict() {
+    // the newest entry always stays, even when it alone is larger than the limit
+    while (lru_list_.size() > 1 && (lru_list_.size() > max_count_ || bytes_ > max_bytes_)) {
+        auto &oldest = lru_list_.back();
+        bytes_ -= oldest->GetSize();
+        buffer_map_.erase(oldest->GetPath());
+        lru_list_.pop_back();
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef MMAP_BUFFER_H
+#define MMAP_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "error_code.h"
+#include "buffer.h"
+
+enum class MmapAdvice {
+    Normal,
+    Sequential,
+    Random,
+    WillNeed,
+};
+
+/**
+ * 只读映射文件(或文件的一段)的buffer，可以直接放入发送队列而不拷贝
+ * 文件在映射期间被修改时内容也会变化，替换文件应使用rename
+ */
+class MmapBuffer : public Buffer {
+public:
+    using Ptr = std::shared_ptr<MmapBuffer>;
+
+    /**
+     * 映射文件
+     * @param path 文件路径
+     * @param buffer 映射的buffer
+     * @param offset 起始偏移，不需要页对齐
+     * @param length 长度，0时映射到文件末尾，超出文件时截断，截断后超过INT_MAX时返回File_Too_Large
+     */
+    static ErrorCode Create(const std::string &path, Ptr &buffer, size_t offset = 0, size_t length = 0);
+
+    MmapBuffer(const MmapBuffer &other) = delete;
+
+    MmapBuffer &operator=(const MmapBuffer &other) = delete;
+
+    ~MmapBuffer() override;
+
+public:
+    const char *GetData() const override;
+
+    int GetContentSize() const override;
+
+    /**
+     * 映射的字节数，与GetContentSize相同但不经过int
+     */
+    size_t GetSize() const;
+
+    bool IsRetainable() const override;
+
+    bool Advise(MmapAdvice advice);
+
+    const std::string &GetPath() const;
+
+    /**
+     * 映射时文件的修改时间，单位纳秒
+     */
+    int64_t GetModifyTime() const;
+
+private:
+    MmapBuffer() = default;
+
+private:
+    std::string path_;
+    int64_t modify_time_ = 0;
+    char *map_data_ = nullptr;
+    size_t map_size_ = 0;
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * 按路径缓存整个文件的映射，按最近使用淘汰
+ * 每次Get只stat文件，修改时间或大小变化时重新映射
+ */
+class MmapBufferCache {
+public:
+    explicit MmapBufferCache(size_t max_count = 64, size_t max_bytes = 256 * 1024 * 1024);
+
+    MmapBufferCache(const MmapBufferCache &other) = delete;
+
+    MmapBufferCache &operator=(const MmapBufferCache &other) = delete;
+
+    ~MmapBufferCache();
+
+public:
+    /**
+     * 获取文件的映射，新映射的文件会设置MmapAdvice::WillNeed
+     */
+    ErrorCode Get(const std::string &path, MmapBuffer::Ptr &buffer);
+
+    void Remove(const std::string &path);
+
+    void Clear();
+
+    size_t GetCount();
+
+    size_t GetBytes();
+
+private:
+    void Evict();
+
+private:
+    size_t max_count_;
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    std::mutex mutex_;
+    std::list<MmapBuffer::Ptr> lru_list_;
+    std::unordered_map<std::string, std::list<MmapBuffer::Ptr>::iterator> buffer_map_;
+};
+
+#endif //MMAP_BUFFER_H
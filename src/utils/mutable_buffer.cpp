@@ -2,14 +2,21 @@
 
 #include <cstring>
 
-MutableBuffer::MutableBuffer(int capacity) {
+#include "buffer_pool.h"
+
+MutableBuffer::MutableBuffer(int capacity)
+        : MutableBuffer(capacity, nullptr) {
+}
+
+MutableBuffer::MutableBuffer(int capacity, MemoryAllocator::Ptr allocator)
+        : allocator_(allocator ? std::move(allocator) : BufferPool::GetInstance()) {
     capacity_ = capacity;
-    buffer_ = new char[capacity_];
+    buffer_ = AllocateBuffer(capacity_);
     content_size_ = 0;
 }
 
 MutableBuffer::~MutableBuffer() {
-    delete[] buffer_;
+    DeallocateBuffer(buffer_, capacity_);
 }
 
 int MutableBuffer::GetCapacity() const {
@@ -38,10 +45,10 @@ ErrorCode MutableBuffer::SetCapacity(int capacity) {
         }
     } while (false);
 
-    auto buffer = new char[capacity];
+    auto buffer = AllocateBuffer(capacity);
     memcpy(buffer, buffer_, content_size_);
 
-    delete[] buffer_;
+    DeallocateBuffer(buffer_, capacity_);
     buffer_ = buffer;
     capacity_ = capacity;
 
@@ -97,3 +104,11 @@ void MutableBuffer::ConsumeData(int length) {
 void MutableBuffer::Reset() {
     content_size_ = 0;
 }
+
+char *MutableBuffer::AllocateBuffer(int capacity) {
+    return allocator_->Allocate(capacity);
+}
+
+void MutableBuffer::DeallocateBuffer(char *buffer, int capacity) {
+    allocator_->Deallocate(buffer, capacity);
+}
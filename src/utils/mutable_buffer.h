@@ -5,6 +5,7 @@
 
 #include "error_code.h"
 #include "buffer.h"
+#include "memory_allocator.h"
 
 class MutableBuffer : public Buffer {
 public:
@@ -12,6 +13,8 @@ public:
 
     explicit MutableBuffer(int capacity);
 
+    explicit MutableBuffer(int capacity, MemoryAllocator::Ptr allocator);
+
     MutableBuffer(const MutableBuffer &other) = delete;
 
     MutableBuffer operator=(const MutableBuffer &other) = delete;
@@ -40,6 +43,12 @@ public:
     void Reset();
 
 private:
+    char *AllocateBuffer(int capacity);
+
+    void DeallocateBuffer(char *buffer, int capacity);
+
+private:
+    MemoryAllocator::Ptr allocator_;
     int capacity_;
     char *buffer_;
     int content_size_;
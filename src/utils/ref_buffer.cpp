@@ -0,0 +1,59 @@
+#include "ref_buffer.h"
+
+#include <cstring>
+#include <new>
+
+#include "buffer_pool.h"
+
+RefBuffer::RefBuffer(int size, RefCountMode mode)
+        : RefCounted(mode), size_(size) {
+}
+
+RefBuffer::~RefBuffer() = default;
+
+RefBuffer::Ref RefBuffer::Create(const char *data, int size, RefCountMode mode) {
+    if (size < 0) {
+        size = 0;
+    }
+
+    // the data follows the object in the same block
+    auto memory = BufferPool::GetInstance()->Allocate(sizeof(RefBuffer) + size + 1);
+    auto buffer = new(memory) RefBuffer(size, mode);
+    auto content = memory + sizeof(RefBuffer);
+    if (size > 0) {
+        memcpy(content, data, size);
+    }
+    content[size] = 0;
+
+    return Ref(buffer);
+}
+
+Buffer::Ptr RefBuffer::ToShared(const Ref &buffer) {
+    if (!buffer) {
+        return nullptr;
+    }
+
+    // a local count must not be touched by whichever thread drops the shared_ptr
+    auto holder = buffer->GetRefCountMode() == RefCountMode::Local
+                  ? Create(buffer->GetData(), buffer->GetContentSize(), RefCountMode::Atomic).detach()
+                  : Ref(buffer).detach();
+    return Buffer::Ptr(holder, [](RefBuffer *data) { data->Release(); }, BufferPoolAllocator<RefBuffer>());
+}
+
+const char *RefBuffer::GetData() const {
+    return reinterpret_cast<const char *>(this) + sizeof(RefBuffer);
+}
+
+int RefBuffer::GetContentSize() const {
+    return size_;
+}
+
+bool RefBuffer::IsRetainable() const {
+    return true;
+}
+
+void RefBuffer::Destroy() const {
+    auto size = sizeof(RefBuffer) + size_ + 1;
+    this->~RefBuffer();
+    BufferPool::GetInstance()->Deallocate(reinterpret_cast<char *>(const_cast<RefBuffer *>(this)), size);
+}
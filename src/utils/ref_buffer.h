@@ -0,0 +1,47 @@
+#ifndef REF_BUFFER_H
+#define REF_BUFFER_H
+
+#include "buffer.h"
+#include "ref_counted.h"
+
+/**
+ * 侵入式引用计数的buffer，对象和数据从BufferPool一次分配，没有shared_ptr的控制块
+ * Local模式的计数不是原子的，只能在一个线程内持有；交给Socket::Send时需要把最后一个引用move进去
+ */
+class RefBuffer : public Buffer, public RefCounted {
+public:
+    using Ref = IntrusivePtr<RefBuffer>;
+
+    RefBuffer(const RefBuffer &other) = delete;
+
+    RefBuffer &operator=(const RefBuffer &other) = delete;
+
+    static Ref Create(const char *data, int size, RefCountMode mode = RefCountMode::Atomic);
+
+    /**
+     * 转为Buffer::Ptr供现有接口使用，shared_ptr存活期间持有一个引用
+     * 会分配一个控制块，只在需要与shared_ptr接口交互时使用
+     * shared_ptr可能在其他线程释放，Local模式的buffer会拷贝为一个Atomic模式的buffer
+     */
+    static Buffer::Ptr ToShared(const Ref &buffer);
+
+public:
+    const char *GetData() const override;
+
+    int GetContentSize() const override;
+
+    bool IsRetainable() const override;
+
+protected:
+    void Destroy() const override;
+
+private:
+    explicit RefBuffer(int size, RefCountMode mode);
+
+    ~RefBuffer() override;
+
+private:
+    int size_;
+};
+
+#endif //REF_BUFFER_H
@@ -0,0 +1,169 @@
+#ifndef REF_COUNTED_H
+#define REF_COUNTED_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * 引用计数方式
+ * Atomic: 原子加减，可以在线程间传递
+ * Local: 普通加减(无lock前缀)，所有引用必须在同一线程内持有和释放，适合只在一个poll线程内流转的对象
+ */
+enum class RefCountMode {
+    Atomic,
+    Local,
+};
+
+/**
+ * 侵入式引用计数基类，计数与对象在同一块内存，不需要单独的控制块
+ * 计数归零时调用Destroy，默认delete自身，自定义分配方式的子类可以重写
+ */
+class RefCounted {
+public:
+    explicit RefCounted(RefCountMode mode = RefCountMode::Atomic) : mode_(mode) {
+    }
+
+    RefCounted(const RefCounted &other) = delete;
+
+    RefCounted &operator=(const RefCounted &other) = delete;
+
+    virtual ~RefCounted() = default;
+
+public:
+    void AddRef() const {
+        if (mode_ == RefCountMode::Local) {
+            ref_count_.store(ref_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            ref_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Release() const {
+        if (mode_ == RefCountMode::Local) {
+            auto count = ref_count_.load(std::memory_order_relaxed) - 1;
+            ref_count_.store(count, std::memory_order_relaxed);
+            if (count == 0) {
+                Destroy();
+            }
+        } else if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Destroy();
+        }
+    }
+
+    int GetRefCount() const {
+        return ref_count_.load(std::memory_order_relaxed);
+    }
+
+    RefCountMode GetRefCountMode() const {
+        return mode_;
+    }
+
+protected:
+    virtual void Destroy() const {
+        delete this;
+    }
+
+private:
+    mutable std::atomic<int> ref_count_{0};
+    const RefCountMode mode_;
+};
+
+/**
+ * 持有RefCounted对象的智能指针，用法与shared_ptr一致，移动不修改计数
+ */
+template<typename T>
+class IntrusivePtr {
+public:
+    IntrusivePtr() = default;
+
+    IntrusivePtr(std::nullptr_t) {
+    }
+
+    explicit IntrusivePtr(T *ptr) : ptr_(ptr) {
+        if (ptr_) {
+            ptr_->AddRef();
+        }
+    }
+
+    IntrusivePtr(const IntrusivePtr &other) : IntrusivePtr(other.ptr_) {
+    }
+
+    IntrusivePtr(IntrusivePtr &&other) noexcept : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+    template<typename U>
+    IntrusivePtr(const IntrusivePtr<U> &other) : IntrusivePtr(other.get()) {
+    }
+
+    ~IntrusivePtr() {
+        if (ptr_) {
+            ptr_->Release();
+        }
+    }
+
+    IntrusivePtr &operator=(IntrusivePtr other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+public:
+    T *get() const {
+        return ptr_;
+    }
+
+    T *operator->() const {
+        return ptr_;
+    }
+
+    T &operator*() const {
+        return *ptr_;
+    }
+
+    explicit operator bool() const {
+        return ptr_ != nullptr;
+    }
+
+    void reset() {
+        IntrusivePtr().swap(*this);
+    }
+
+    void swap(IntrusivePtr &other) noexcept {
+        std::swap(ptr_, other.ptr_);
+    }
+
+    /**
+     * 交出所有权而不减少计数，需要由调用者之后Release
+     */
+    T *detach() {
+        auto ptr = ptr_;
+        ptr_ = nullptr;
+        return ptr;
+    }
+
+private:
+    T *ptr_ = nullptr;
+};
+
+template<typename T, typename U>
+bool operator==(const IntrusivePtr<T> &left, const IntrusivePtr<U> &right) {
+    return left.get() == right.get();
+}
+
+template<typename T, typename U>
+bool operator!=(const IntrusivePtr<T> &left, const IntrusivePtr<U> &right) {
+    return left.get() != right.get();
+}
+
+template<typename T>
+bool operator==(const IntrusivePtr<T> &left, std::nullptr_t) {
+    return left.get() == nullptr;
+}
+
+template<typename T>
+bool operator!=(const IntrusivePtr<T> &left, std::nullptr_t) {
+    return left.get() != nullptr;
+}
+
+#endif //REF_COUNTED_H
@@ -0,0 +1,166 @@
+#include "ring_buffer.h"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "buffer_pool.h"
+
+RingBuffer::RingBuffer(int capacity, bool mirrored, bool prefault)
+        : capacity_(capacity) {
+    if (mirrored && MapMirror(prefault)) {
+        mirrored_ = true;
+        return;
+    }
+
+    allocator_ = BufferPool::GetInstance();
+    buffer_ = allocator_->Allocate(capacity_);
+    if (prefault) {
+        memset(buffer_, 0, capacity_);
+    }
+}
+
+RingBuffer::~RingBuffer() {
+    if (mirrored_) {
+        munmap(buffer_, 2 * static_cast<size_t>(capacity_));
+    } else {
+        allocator_->Deallocate(buffer_, capacity_);
+    }
+}
+
+int RingBuffer::GetCapacity() const {
+    return capacity_;
+}
+
+bool RingBuffer::IsMirrored() const {
+    return mirrored_;
+}
+
+const char *RingBuffer::GetData() const {
+    return buffer_ + read_offset_;
+}
+
+int RingBuffer::GetContentSize() const {
+    return content_size_;
+}
+
+char *RingBuffer::GetWritableData(int length) {
+    if (GetTailSpace() < length) {
+        // compact lazily, only when the write does not fit behind the content
+        memmove(buffer_, buffer_ + read_offset_, content_size_);
+        read_offset_ = 0;
+    }
+
+    return buffer_ + read_offset_ + content_size_;
+}
+
+int RingBuffer::GetAvailableSpace() const {
+    return capacity_ - content_size_;
+}
+
+int RingBuffer::GetTailSpace() const {
+    if (mirrored_) {
+        return capacity_ - content_size_;
+    }
+
+    return capacity_ - read_offset_ - content_size_;
+}
+
+ErrorCode RingBuffer::AppendData(const char *data, int length) {
+    if (GetAvailableSpace() < length) {
+        return Buffer_Not_Enough_Capacity;
+    }
+
+    memcpy(GetWritableData(length), data, length);
+    content_size_ += length;
+
+    return Success;
+}
+
+ErrorCode RingBuffer::IncreaseContentSize(int increased_size) {
+    if (GetTailSpace() < increased_size) {
+        return Buffer_Not_Enough_Capacity;
+    }
+
+    content_size_ += increased_size;
+
+    return Success;
+}
+
+void RingBuffer::ConsumeData(int length) {
+    if (length >= content_size_) {
+        Reset();
+        return;
+    }
+
+    read_offset_ += length;
+    content_size_ -= length;
+    if (mirrored_ && read_offset_ >= capacity_) {
+        read_offset_ -= capacity_;
+    }
+}
+
+void RingBuffer::Reset() {
+    read_offset_ = 0;
+    content_size_ = 0;
+}
+
+ssize_t RingBuffer::ReadFrom(int fd) {
+    auto space = GetAvailableSpace();
+    if (space == 0) {
+        return 0;
+    }
+
+    // read into the tail directly while it holds at least half of the free space
+    if (GetTailSpace() >= space / 2 && GetTailSpace() > 0) {
+        space = GetTailSpace();
+    }
+
+    auto count = read(fd, GetWritableData(space), static_cast<size_t>(space));
+    if (count > 0) {
+        content_size_ += static_cast<int>(count);
+    }
+
+    return count;
+}
+
+bool RingBuffer::MapMirror(bool prefault) {
+#ifdef SYS_memfd_create
+    auto page_size = PageAllocator::GetPageSize();
+    auto size = (static_cast<size_t>(capacity_) + page_size - 1) / page_size * page_size;
+
+    int fd = static_cast<int>(syscall(SYS_memfd_create, "ring_buffer", 0));
+    if (fd < 0) {
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // reserve the address range of both halves first, then map the same pages into each half
+    auto base = static_cast<char *>(mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    auto flags = MAP_SHARED | MAP_FIXED | (prefault ? MAP_POPULATE : 0);
+    auto first = mmap(base, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    auto second = mmap(base + size, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    close(fd);
+
+    if (first == MAP_FAILED || second == MAP_FAILED) {
+        munmap(base, 2 * size);
+        return false;
+    }
+
+    buffer_ = base;
+    capacity_ = static_cast<int>(size);
+    return true;
+#else
+    return false;
+#endif
+}
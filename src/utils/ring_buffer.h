@@ -0,0 +1,85 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <memory>
+#include <sys/types.h>
+
+#include "error_code.h"
+#include "buffer.h"
+#include "memory_allocator.h"
+
+/**
+ * 环形缓冲区，ConsumeData为O(1)，接口与MutableBuffer相同，适合流式协议逐帧解析
+ * 镜像模式下同一块内存被连续映射两次，数据和空闲空间始终连续，不需要拷贝
+ * 镜像映射失败或者不使用镜像时，消费只移动读偏移，尾部空间不够写入时才把剩余数据移到头部
+ */
+class RingBuffer : public Buffer {
+public:
+    using Ptr = std::shared_ptr<RingBuffer>;
+
+    /**
+     * @param capacity 容量，镜像模式下按页大小向上取整
+     * @param mirrored 是否使用镜像映射
+     * @param prefault 是否在创建时预先缺页
+     */
+    explicit RingBuffer(int capacity, bool mirrored = true, bool prefault = false);
+
+    RingBuffer(const RingBuffer &other) = delete;
+
+    RingBuffer &operator=(const RingBuffer &other) = delete;
+
+    ~RingBuffer() override;
+
+public:
+    int GetCapacity() const;
+
+    bool IsMirrored() const;
+
+    const char *GetData() const override;
+
+    int GetContentSize() const override;
+
+    /**
+     * 获取空闲空间的起始地址，之后至少length字节可以连续写入，写入后调用IncreaseContentSize
+     * 非镜像模式下只有尾部空间小于length时才移动数据
+     * @param length 需要连续写入的字节数，不能超过GetAvailableSpace()
+     */
+    char *GetWritableData(int length);
+
+    /**
+     * 获取总的空闲空间
+     */
+    int GetAvailableSpace() const;
+
+    /**
+     * 获取不移动数据时可以连续写入的空闲空间，镜像模式下等于GetAvailableSpace()
+     */
+    int GetTailSpace() const;
+
+    ErrorCode AppendData(const char *data, int length);
+
+    ErrorCode IncreaseContentSize(int increased_size);
+
+    void ConsumeData(int length);
+
+    void Reset();
+
+    /**
+     * 从fd直接读取到空闲空间
+     * @return read的返回值，空间已满时返回0
+     */
+    ssize_t ReadFrom(int fd);
+
+private:
+    bool MapMirror(bool prefault);
+
+private:
+    MemoryAllocator::Ptr allocator_;
+    char *buffer_ = nullptr;
+    int capacity_ = 0;
+    int read_offset_ = 0;
+    int content_size_ = 0;
+    bool mirrored_ = false;
+};
+
+#endif //RING_BUFFER_H
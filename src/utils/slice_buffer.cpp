@@ -0,0 +1,59 @@
+#include "slice_buffer.h"
+
+#include <algorithm>
+
+#include "copy_buffer.h"
+
+SliceBuffer::SliceBuffer(const Buffer::Ptr &parent, int offset, int length)
+        : parent_(parent) {
+    auto size = parent->GetContentSize();
+    offset_ = std::min(std::max(offset, 0), size);
+    length_ = std::min(std::max(length, 0), size - offset_);
+
+    auto slice = std::dynamic_pointer_cast<SliceBuffer>(parent);
+    if (slice) {
+        parent_ = slice->parent_;
+        offset_ += slice->offset_;
+    }
+}
+
+SliceBuffer::~SliceBuffer() = default;
+
+const char *SliceBuffer::GetData() const {
+    return parent_->GetData() + offset_;
+}
+
+int SliceBuffer::GetContentSize() const {
+    return length_;
+}
+
+bool SliceBuffer::IsRetainable() const {
+    return parent_->IsRetainable();
+}
+
+const Buffer::Ptr &SliceBuffer::GetParent() const {
+    return parent_;
+}
+
+int SliceBuffer::GetOffset() const {
+    return offset_;
+}
+
+SliceBuffer::Ptr SliceBuffer::Slice(int offset, int length) const {
+    offset = std::min(std::max(offset, 0), length_);
+    length = std::min(std::max(length, 0), length_ - offset);
+
+    return std::make_shared<SliceBuffer>(parent_, offset_ + offset, length);
+}
+
+SliceBuffer::Ptr SliceBuffer::Create(const Buffer::Ptr &buffer, int offset, int length) {
+    return std::make_shared<SliceBuffer>(buffer, offset, length);
+}
+
+Buffer::Ptr SliceBuffer::Retain(const Buffer::Ptr &buffer) {
+    if (buffer->IsRetainable()) {
+        return buffer;
+    }
+
+    return CopyBuffer::Create(buffer->GetData(), buffer->GetContentSize());
+}
@@ -0,0 +1,62 @@
+#ifndef SLICE_BUFFER_H
+#define SLICE_BUFFER_H
+
+#include <memory>
+
+#include "buffer.h"
+
+/**
+ * buffer的一段子区间，与父buffer共享数据，不拷贝
+ * 父buffer可以继续引用(IsRetainable)时切片也可以继续引用，否则只在父buffer有效期间可用，需要先Retain
+ */
+class SliceBuffer : public Buffer {
+public:
+    using Ptr = std::shared_ptr<SliceBuffer>;
+
+    /**
+     * @param parent 父buffer，如果也是切片则直接引用其父buffer
+     * @param offset 在parent中的偏移，超出范围时截断
+     * @param length 长度，超出范围时截断
+     */
+    explicit SliceBuffer(const Buffer::Ptr &parent, int offset, int length);
+
+    SliceBuffer(const SliceBuffer &other) = delete;
+
+    SliceBuffer &operator=(const SliceBuffer &other) = delete;
+
+    ~SliceBuffer() override;
+
+public:
+    const char *GetData() const override;
+
+    int GetContentSize() const override;
+
+    bool IsRetainable() const override;
+
+    const Buffer::Ptr &GetParent() const;
+
+    int GetOffset() const;
+
+    /**
+     * 在当前切片上再切一段，偏移相对于当前切片
+     */
+    Ptr Slice(int offset, int length) const;
+
+    /**
+     * 切片的便捷写法
+     */
+    static Ptr Create(const Buffer::Ptr &buffer, int offset, int length);
+
+    /**
+     * 返回可以长期引用的buffer，本身可引用时直接返回，否则拷贝一次
+     * 例如在读回调中先Retain整个接收buffer，再切成多个消息转发，只产生一次拷贝
+     */
+    static Buffer::Ptr Retain(const Buffer::Ptr &buffer);
+
+private:
+    Buffer::Ptr parent_;
+    int offset_ = 0;
+    int length_ = 0;
+};
+
+#endif //SLICE_BUFFER_H
@@ -0,0 +1,3 @@
+#include "string_view.h"
+
+constexpr size_t StringView::npos;
@@ -0,0 +1,142 @@
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * 不持有数据的字符串视图，C++11下代替std::string_view，接口与其一致
+ */
+class StringView {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    constexpr StringView() : data_(nullptr), size_(0) {
+    }
+
+    constexpr StringView(const char *data, size_t size) : data_(data), size_(size) {
+    }
+
+    StringView(const char *data) : data_(data), size_(data ? strlen(data) : 0) {
+    }
+
+    StringView(const std::string &data) : data_(data.data()), size_(data.size()) {
+    }
+
+public:
+    constexpr const char *data() const {
+        return data_;
+    }
+
+    constexpr size_t size() const {
+        return size_;
+    }
+
+    constexpr bool empty() const {
+        return size_ == 0;
+    }
+
+    constexpr const char *begin() const {
+        return data_;
+    }
+
+    constexpr const char *end() const {
+        return data_ + size_;
+    }
+
+    constexpr char operator[](size_t index) const {
+        return data_[index];
+    }
+
+    StringView substr(size_t pos, size_t count = npos) const {
+        pos = std::min(pos, size_);
+        return StringView(data_ + pos, std::min(count, size_ - pos));
+    }
+
+    void remove_prefix(size_t count) {
+        data_ += count;
+        size_ -= count;
+    }
+
+    void remove_suffix(size_t count) {
+        size_ -= count;
+    }
+
+    size_t find(char c, size_t pos = 0) const {
+        if (pos >= size_) {
+            return npos;
+        }
+
+        auto found = static_cast<const char *>(memchr(data_ + pos, c, size_ - pos));
+        return found ? static_cast<size_t>(found - data_) : npos;
+    }
+
+    size_t find(StringView other, size_t pos = 0) const {
+        if (other.size_ == 0) {
+            return pos <= size_ ? pos : npos;
+        }
+
+        if (pos >= size_ || other.size_ > size_ - pos) {
+            return npos;
+        }
+
+        // memchr to the candidates of the first character, then compare the rest
+        auto last = data_ + size_ - other.size_;
+        auto current = data_ + pos;
+        while (current <= last) {
+            current = static_cast<const char *>(memchr(current, other.data_[0], last - current + 1));
+            if (current == nullptr) {
+                return npos;
+            }
+
+            if (memcmp(current + 1, other.data_ + 1, other.size_ - 1) == 0) {
+                return static_cast<size_t>(current - data_);
+            }
+
+            ++current;
+        }
+
+        return npos;
+    }
+
+    int compare(StringView other) const {
+        auto result = memcmp(data_, other.data_, std::min(size_, other.size_));
+        if (result != 0) {
+            return result;
+        }
+
+        return size_ == other.size_ ? 0 : (size_ < other.size_ ? -1 : 1);
+    }
+
+    bool starts_with(StringView prefix) const {
+        return size_ >= prefix.size_ && memcmp(data_, prefix.data_, prefix.size_) == 0;
+    }
+
+    bool ends_with(StringView suffix) const {
+        return size_ >= suffix.size_ && memcmp(data_ + size_ - suffix.size_, suffix.data_, suffix.size_) == 0;
+    }
+
+    std::string ToString() const {
+        return std::string(data_, size_);
+    }
+
+private:
+    const char *data_;
+    size_t size_;
+};
+
+inline bool operator==(StringView left, StringView right) {
+    return left.size() == right.size() && memcmp(left.data(), right.data(), left.size()) == 0;
+}
+
+inline bool operator!=(StringView left, StringView right) {
+    return !(left == right);
+}
+
+inline bool operator<(StringView left, StringView right) {
+    return left.compare(right) < 0;
+}
+
+#endif //STRING_VIEW_H
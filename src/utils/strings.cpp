@@ -1,6 +1,48 @@
 #include "strings.h"
 
-#include <sstream>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define STRINGS_X86 1
+#endif
+
+static const char kHexDigits[] = "0123456789abcdef";
+
+static size_t hex_encode_scalar(const uint8_t *data, size_t size, char *output);
+
+static bool hex_decode_scalar(const char *data, size_t size, char *output);
+
+static const char kBase64Standard[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const char kBase64UrlSafe[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static size_t base64_encode_scalar(const uint8_t *data, size_t size, char *output, Base64Alphabet alphabet,
+                                   bool padding);
+
+static bool base64_decode_scalar(const char *data, size_t size, char *output, size_t &written,
+                                 Base64Alphabet alphabet);
+
+#ifdef STRINGS_X86
+
+static size_t hex_encode_sse2(const uint8_t *data, size_t size, char *output);
+
+static bool hex_decode_sse2(const char *data, size_t size, char *output);
+
+__attribute__((target("avx2"))) static size_t hex_encode_avx2(const uint8_t *data, size_t size, char *output);
+
+__attribute__((target("avx2"))) static bool hex_decode_avx2(const char *data, size_t size, char *output);
+
+__attribute__((target("avx2")))
+static size_t base64_encode_avx2(const uint8_t *data, size_t size, char *output, Base64Alphabet alphabet);
+
+__attribute__((target("avx2")))
+static size_t base64_decode_avx2(const char *data, size_t size, char *output, Base64Alphabet alphabet);
+
+static bool has_avx2();
+
+#endif
 
 std::vector<std::string> Strings::Split(const std::string &data, const std::string &delim) {
     std::vector<std::string> result;
@@ -68,22 +110,647 @@ std::string Strings::Trim(const std::string &data, const std::function<bool(char
     return data.substr(start_position, end_position - start_position + 1);
 }
 
+StringSplitter Strings::SplitView(StringView data, StringView delim, bool skip_empty) {
+    return StringSplitter(data, delim, skip_empty);
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+StringView Strings::TrimSpaceView(StringView data) {
+    return TrimView(data, [](char c) { return !is_space(c); });
+}
+
+StringSplitter::StringSplitter(StringView data, StringView delim, bool skip_empty)
+        : data_(data), delim_(delim), skip_empty_(skip_empty) {
+}
+
+bool StringSplitter::Next(StringView &token) {
+    while (!finished_) {
+        auto position = delim_.size() == 1 ? data_.find(delim_[0]) : data_.find(delim_);
+        if (delim_.empty() || position == StringView::npos) {
+            token = data_;
+            finished_ = true;
+        } else {
+            token = data_.substr(0, position);
+            data_.remove_prefix(position + delim_.size());
+        }
+
+        if (!skip_empty_ || !token.empty()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+StringSplitter::Iterator::Iterator(StringSplitter *splitter)
+        : splitter_(splitter) {
+    if (splitter_) {
+        ++*this;
+    }
+}
+
+StringSplitter::Iterator &StringSplitter::Iterator::operator++() {
+    if (!splitter_->Next(token_)) {
+        splitter_ = nullptr;
+    }
+
+    return *this;
+}
+
 std::string Strings::Hex2Bin(const std::string &str) {
-    std::string result;
-    for (size_t i = 0; i < str.length(); i += 2) {
-        std::string byte = str.substr(i, 2);
-        char chr = (char) strtol(byte.c_str(), nullptr, 16);
-        result.push_back(chr);
+    std::string result(str.size() / 2, '\0');
+    if (!HexDecode(str.data(), str.size(), &result[0])) {
+        return "";
     }
+
     return result;
 }
 
 std::string Strings::Bin2Hex(const std::string &data) {
-    char temp[3] = {0};
-    std::stringstream ss;
-    for (unsigned char i: data) {
-        sprintf(temp, "%02x", i);
-        ss << temp;
+    std::string result(data.size() * 2, '\0');
+    HexEncode(data.data(), data.size(), &result[0]);
+
+    return result;
+}
+
+size_t Strings::HexEncode(const char *data, size_t size, char *output) {
+    auto input = reinterpret_cast<const uint8_t *>(data);
+
+#ifdef STRINGS_X86
+    size_t done = has_avx2() ? hex_encode_avx2(input, size, output) : hex_encode_sse2(input, size, output);
+    hex_encode_scalar(input + done, size - done, output + done * 2);
+#else
+    hex_encode_scalar(input, size, output);
+#endif
+
+    return size * 2;
+}
+
+bool Strings::HexDecode(const char *data, size_t size, char *output) {
+    if (size % 2 != 0) {
+        return false;
+    }
+
+#ifdef STRINGS_X86
+    auto count = size / 2;
+    auto done = count - count % 16;
+    if (done > 0) {
+        auto valid = has_avx2() ? hex_decode_avx2(data, done * 2, output) : hex_decode_sse2(data, done * 2, output);
+        if (!valid) {
+            return false;
+        }
+    }
+
+    return hex_decode_scalar(data + done * 2, size - done * 2, output + done);
+#else
+    return hex_decode_scalar(data, size, output);
+#endif
+}
+
+size_t Strings::GetBase64EncodedSize(size_t size, bool padding) {
+    if (padding) {
+        return (size + 2) / 3 * 4;
+    }
+
+    return size / 3 * 4 + (size % 3 == 0 ? 0 : size % 3 + 1);
+}
+
+size_t Strings::Base64Encode(const char *data, size_t size, char *output, Base64Alphabet alphabet, bool padding) {
+    auto input = reinterpret_cast<const uint8_t *>(data);
+
+    size_t done = 0;
+#ifdef STRINGS_X86
+    if (has_avx2()) {
+        done = base64_encode_avx2(input, size, output, alphabet);
+    }
+#endif
+
+    return done / 3 * 4 + base64_encode_scalar(input + done, size - done, output + done / 3 * 4, alphabet, padding);
+}
+
+bool Strings::Base64Decode(const char *data, size_t size, char *output, size_t &written, Base64Alphabet alphabet) {
+    size_t done = 0;
+#ifdef STRINGS_X86
+    if (has_avx2()) {
+        // stops before the first block with padding or an invalid character, the scalar loop handles it
+        done = base64_decode_avx2(data, size, output, alphabet);
+    }
+#endif
+
+    if (!base64_decode_scalar(data + done, size - done, output + done / 4 * 3, written, alphabet)) {
+        return false;
+    }
+
+    written += done / 4 * 3;
+    return true;
+}
+
+std::string Strings::Base64Encode(StringView data, Base64Alphabet alphabet, bool padding) {
+    std::string result(GetBase64EncodedSize(data.size(), padding), '\0');
+    Base64Encode(data.data(), data.size(), &result[0], alphabet, padding);
+
+    return result;
+}
+
+bool Strings::Base64Decode(StringView data, std::string &result, Base64Alphabet alphabet) {
+    result.resize(Base64Decoder::GetMaxOutputSize(data.size()));
+
+    size_t written = 0;
+    if (!Base64Decode(data.data(), data.size(), &result[0], written, alphabet)) {
+        result.clear();
+        return false;
+    }
+
+    result.resize(written);
+    return true;
+}
+
+Base64Encoder::Base64Encoder(Base64Alphabet alphabet, bool padding)
+        : alphabet_(alphabet), padding_(padding) {
+}
+
+size_t Base64Encoder::GetMaxOutputSize(size_t size) {
+    // up to 2 pending bytes from the previous chunk
+    return (size + 2) / 3 * 4;
+}
+
+size_t Base64Encoder::Update(const char *data, size_t size, char *output) {
+    size_t written = 0;
+
+    if (pending_size_ > 0) {
+        while (pending_size_ < 3 && size > 0) {
+            pending_[pending_size_++] = *data++;
+            --size;
+        }
+
+        if (pending_size_ < 3) {
+            return 0;
+        }
+
+        written += Strings::Base64Encode(pending_, 3, output, alphabet_, false);
+        pending_size_ = 0;
+    }
+
+    auto whole = size - size % 3;
+    written += Strings::Base64Encode(data, whole, output + written, alphabet_, false);
+
+    pending_size_ = size - whole;
+    memcpy(pending_, data + whole, pending_size_);
+
+    return written;
+}
+
+size_t Base64Encoder::Update(const Buffer &buffer, char *output) {
+    return Update(buffer.GetData(), static_cast<size_t>(buffer.GetContentSize()), output);
+}
+
+size_t Base64Encoder::Finish(char *output) {
+    auto written = Strings::Base64Encode(pending_, pending_size_, output, alphabet_, padding_);
+    pending_size_ = 0;
+
+    return written;
+}
+
+Base64Decoder::Base64Decoder(Base64Alphabet alphabet)
+        : alphabet_(alphabet) {
+}
+
+size_t Base64Decoder::GetMaxOutputSize(size_t size) {
+    // up to 3 pending characters from the previous chunk
+    return (size + 3) / 4 * 3 + 3;
+}
+
+bool Base64Decoder::Update(const char *data, size_t size, char *output, size_t &written) {
+    written = 0;
+    if (size == 0) {
+        return true;
+    }
+
+    if (finished_) {
+        // data after the padding
+        return false;
+    }
+
+    size_t count;
+    if (pending_size_ > 0) {
+        while (pending_size_ < 4 && size > 0) {
+            pending_[pending_size_++] = *data++;
+            --size;
+        }
+
+        if (pending_size_ < 4) {
+            return true;
+        }
+
+        if (!Strings::Base64Decode(pending_, 4, output, count, alphabet_)) {
+            return false;
+        }
+
+        written += count;
+        finished_ = pending_[3] == '=';
+        pending_size_ = 0;
+
+        if (finished_ && size > 0) {
+            return false;
+        }
+    }
+
+    auto whole = size - size % 4;
+    if (whole > 0) {
+        if (!Strings::Base64Decode(data, whole, output + written, count, alphabet_)) {
+            return false;
+        }
+
+        written += count;
+        finished_ = data[whole - 1] == '=';
+
+        if (finished_ && whole < size) {
+            return false;
+        }
+    }
+
+    pending_size_ = size - whole;
+    memcpy(pending_, data + whole, pending_size_);
+
+    return true;
+}
+
+bool Base64Decoder::Update(const Buffer &buffer, char *output, size_t &written) {
+    return Update(buffer.GetData(), static_cast<size_t>(buffer.GetContentSize()), output, written);
+}
+
+bool Base64Decoder::Finish(char *output, size_t &written) {
+    auto valid = Strings::Base64Decode(pending_, pending_size_, output, written, alphabet_);
+
+    pending_size_ = 0;
+    finished_ = false;
+
+    return valid;
+}
+
+static int8_t hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return static_cast<int8_t>(c - '0');
+    }
+
+    c = static_cast<char>(c | 0x20);
+    if (c >= 'a' && c <= 'f') {
+        return static_cast<int8_t>(c - 'a' + 10);
+    }
+
+    return -1;
+}
+
+size_t hex_encode_scalar(const uint8_t *data, size_t size, char *output) {
+    for (size_t i = 0; i < size; ++i) {
+        output[i * 2] = kHexDigits[data[i] >> 4];
+        output[i * 2 + 1] = kHexDigits[data[i] & 0x0F];
+    }
+
+    return size;
+}
+
+bool hex_decode_scalar(const char *data, size_t size, char *output) {
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        auto high = hex_value(data[i]);
+        auto low = hex_value(data[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+
+        output[i / 2] = static_cast<char>((high << 4) | low);
+    }
+
+    return true;
+}
+
+size_t base64_encode_scalar(const uint8_t *data, size_t size, char *output, Base64Alphabet alphabet,
+                            bool padding) {
+    auto table = alphabet == Base64Alphabet::UrlSafe ? kBase64UrlSafe : kBase64Standard;
+
+    size_t i = 0;
+    char *current = output;
+    for (; i + 3 <= size; i += 3) {
+        uint32_t value = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        current[0] = table[value >> 18];
+        current[1] = table[(value >> 12) & 0x3F];
+        current[2] = table[(value >> 6) & 0x3F];
+        current[3] = table[value & 0x3F];
+        current += 4;
+    }
+
+    if (i < size) {
+        uint32_t value = data[i] << 16;
+        if (i + 1 < size) {
+            value |= data[i + 1] << 8;
+        }
+
+        *current++ = table[value >> 18];
+        *current++ = table[(value >> 12) & 0x3F];
+        if (i + 1 < size) {
+            *current++ = table[(value >> 6) & 0x3F];
+        } else if (padding) {
+            *current++ = '=';
+        }
+
+        if (padding) {
+            *current++ = '=';
+        }
+    }
+
+    return static_cast<size_t>(current - output);
+}
+
+struct Base64DecodeTable {
+    explicit Base64DecodeTable(const char *alphabet) {
+        memset(values, -1, sizeof(values));
+        for (int i = 0; i < 64; ++i) {
+            values[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+        }
+    }
+
+    int8_t values[256];
+};
+
+bool base64_decode_scalar(const char *data, size_t size, char *output, size_t &written, Base64Alphabet alphabet) {
+    static const Base64DecodeTable standard(kBase64Standard);
+    static const Base64DecodeTable url_safe(kBase64UrlSafe);
+    auto table = alphabet == Base64Alphabet::UrlSafe ? url_safe.values : standard.values;
+
+    written = 0;
+
+    // padding is only accepted to complete the last group
+    if (size >= 4 && size % 4 == 0 && data[size - 1] == '=') {
+        size -= data[size - 2] == '=' ? 2 : 1;
+    }
+
+    if (size % 4 == 1) {
+        return false;
+    }
+
+    auto input = reinterpret_cast<const uint8_t *>(data);
+    char *current = output;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        int32_t a = table[input[i]];
+        int32_t b = table[input[i + 1]];
+        int32_t c = table[input[i + 2]];
+        int32_t d = table[input[i + 3]];
+        if ((a | b | c | d) < 0) {
+            return false;
+        }
+
+        uint32_t value = (a << 18) | (b << 12) | (c << 6) | d;
+        current[0] = static_cast<char>(value >> 16);
+        current[1] = static_cast<char>(value >> 8);
+        current[2] = static_cast<char>(value);
+        current += 3;
+    }
+
+    if (i < size) {
+        int32_t a = table[input[i]];
+        int32_t b = table[input[i + 1]];
+        int32_t c = i + 2 < size ? table[input[i + 2]] : 0;
+        if ((a | b | c) < 0) {
+            return false;
+        }
+
+        uint32_t value = (a << 18) | (b << 12) | (c << 6);
+        *current++ = static_cast<char>(value >> 16);
+        if (i + 2 < size) {
+            *current++ = static_cast<char>(value >> 8);
+        }
+    }
+
+    written = static_cast<size_t>(current - output);
+    return true;
+}
+
+#ifdef STRINGS_X86
+
+bool has_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+// nibbles to ascii without a shuffle: n + '0', plus ('a' - '0' - 10) when n > 9
+static __m128i nibble_to_hex_sse2(__m128i nibble) {
+    auto alpha = _mm_cmpgt_epi8(nibble, _mm_set1_epi8(9));
+    auto digit = _mm_add_epi8(nibble, _mm_set1_epi8('0'));
+    return _mm_add_epi8(digit, _mm_and_si128(alpha, _mm_set1_epi8('a' - '0' - 10)));
+}
+
+size_t hex_encode_sse2(const uint8_t *data, size_t size, char *output) {
+    auto mask = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        auto value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto high = nibble_to_hex_sse2(_mm_and_si128(_mm_srli_epi16(value, 4), mask));
+        auto low = nibble_to_hex_sse2(_mm_and_si128(value, mask));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+
+    return i;
+}
+
+// ascii to nibbles, valid_mask gets 0xFF for each hex character
+static __m128i hex_to_nibble_sse2(__m128i chars, __m128i &valid_mask) {
+    // c - '0' lands in [0, 9] only for digits, (c | 0x20) - 'a' in [0, 5] only for letters
+    auto digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    auto digit_mask = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-1)),
+                                    _mm_cmpgt_epi8(_mm_set1_epi8(10), digit));
+    auto alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    auto alpha_mask = _mm_and_si128(_mm_cmpgt_epi8(alpha, _mm_set1_epi8(-1)),
+                                    _mm_cmpgt_epi8(_mm_set1_epi8(6), alpha));
+
+    valid_mask = _mm_or_si128(digit_mask, alpha_mask);
+    return _mm_or_si128(_mm_and_si128(digit, digit_mask),
+                        _mm_and_si128(_mm_add_epi8(alpha, _mm_set1_epi8(10)), alpha_mask));
+}
+
+// pairs of nibbles (high in the even byte) to one byte in the low half of each 16 bit lane
+static __m128i merge_nibbles_sse2(__m128i nibbles) {
+    auto high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+    return _mm_or_si128(high, _mm_srli_epi16(nibbles, 8));
+}
+
+bool hex_decode_sse2(const char *data, size_t size, char *output) {
+    for (size_t i = 0; i + 32 <= size; i += 32) {
+        __m128i first_valid;
+        __m128i second_valid;
+        auto first = hex_to_nibble_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), first_valid);
+        auto second = hex_to_nibble_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 16)),
+                                         second_valid);
+        if (_mm_movemask_epi8(_mm_and_si128(first_valid, second_valid)) != 0xFFFF) {
+            return false;
+        }
+
+        auto bytes = _mm_packus_epi16(merge_nibbles_sse2(first), merge_nibbles_sse2(second));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i / 2), bytes);
+    }
+
+    return true;
+}
+
+__attribute__((target("avx2")))
+size_t hex_encode_avx2(const uint8_t *data, size_t size, char *output) {
+    auto mask = _mm256_set1_epi8(0x0F);
+    auto digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                   '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        auto high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(value, 4), mask));
+        auto low = _mm256_shuffle_epi8(digits, _mm256_and_si256(value, mask));
+
+        // unpack works inside each 128 bit lane, put the lanes back in order
+        auto first = _mm256_unpacklo_epi8(high, low);
+        auto second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i * 2),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i * 2 + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
     }
-    return ss.str();
+
+    return i + hex_encode_sse2(data + i, size - i, output + i * 2);
 }
+
+__attribute__((target("avx2")))
+static __m256i hex_to_nibble_avx2(__m256i chars, __m256i &valid_mask) {
+    auto digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    auto digit_mask = _mm256_and_si256(_mm256_cmpgt_epi8(digit, _mm256_set1_epi8(-1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8(10), digit));
+    auto alpha = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    auto alpha_mask = _mm256_and_si256(_mm256_cmpgt_epi8(alpha, _mm256_set1_epi8(-1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8(6), alpha));
+
+    valid_mask = _mm256_or_si256(digit_mask, alpha_mask);
+    return _mm256_or_si256(_mm256_and_si256(digit, digit_mask),
+                           _mm256_and_si256(_mm256_add_epi8(alpha, _mm256_set1_epi8(10)), alpha_mask));
+}
+
+__attribute__((target("avx2")))
+static __m256i merge_nibbles_avx2(__m256i nibbles) {
+    auto high = _mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00FF)), 4);
+    return _mm256_or_si256(high, _mm256_srli_epi16(nibbles, 8));
+}
+
+__attribute__((target("avx2")))
+bool hex_decode_avx2(const char *data, size_t size, char *output) {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i first_valid;
+        __m256i second_valid;
+        auto first = hex_to_nibble_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)),
+                                        first_valid);
+        auto second = hex_to_nibble_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32)),
+                                         second_valid);
+        if (_mm256_movemask_epi8(_mm256_and_si256(first_valid, second_valid)) != -1) {
+            return false;
+        }
+
+        // pack works inside each 128 bit lane as well
+        auto bytes = _mm256_packus_epi16(merge_nibbles_avx2(first), merge_nibbles_avx2(second));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i / 2), _mm256_permute4x64_epi64(bytes, 0xD8));
+    }
+
+    return hex_decode_sse2(data + i, size - i, output + i / 2);
+}
+
+__attribute__((target("avx2")))
+size_t base64_encode_avx2(const uint8_t *data, size_t size, char *output, Base64Alphabet alphabet) {
+    // each lane spreads 12 input bytes into 16 bytes of [b1, b0, b2, b1]
+    auto spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                   1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    char plus = alphabet == Base64Alphabet::UrlSafe ? '-' : '+';
+    char slash = alphabet == Base64Alphabet::UrlSafe ? '_' : '/';
+    auto shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                  '0' - 52, '0' - 52, '0' - 52, static_cast<char>(plus - 62),
+                                  static_cast<char>(slash - 63), 'A', 0, 0,
+                                  'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                  '0' - 52, '0' - 52, '0' - 52, static_cast<char>(plus - 62),
+                                  static_cast<char>(slash - 63), 'A', 0, 0);
+
+    size_t i = 0;
+    // two 16 byte loads per 24 input bytes, the second one reads 4 bytes ahead
+    for (; i + 28 <= size; i += 24) {
+        auto low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 12));
+        auto input = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), spread);
+
+        // move the four 6 bit fields of each 32 bit word into separate bytes
+        auto first = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)),
+                                        _mm256_set1_epi32(0x04000040));
+        auto second = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)),
+                                         _mm256_set1_epi32(0x01000010));
+        auto indices = _mm256_or_si256(first, second);
+
+        // 0-25 -> 13, 26-51 -> 0, 52-61 -> 1-10, 62 -> 11, 63 -> 12, then add the shift of the range
+        auto range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        auto upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+        auto chars = _mm256_add_epi8(_mm256_shuffle_epi8(shift, range), indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i / 3 * 4), chars);
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static __m256i in_range_avx2(__m256i chars, char low, char high) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(static_cast<char>(low - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), chars));
+}
+
+__attribute__((target("avx2")))
+size_t base64_decode_avx2(const char *data, size_t size, char *output, Base64Alphabet alphabet) {
+    auto plus = _mm256_set1_epi8(alphabet == Base64Alphabet::UrlSafe ? '-' : '+');
+    auto slash = _mm256_set1_epi8(alphabet == Base64Alphabet::UrlSafe ? '_' : '/');
+    auto pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    auto compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+
+        // characters outside 0x00-0x7F are negative and fall out of every range
+        auto upper = in_range_avx2(chars, 'A', 'Z');
+        auto lower = in_range_avx2(chars, 'a', 'z');
+        auto digit = in_range_avx2(chars, '0', '9');
+        auto is_plus = _mm256_cmpeq_epi8(chars, plus);
+        auto is_slash = _mm256_cmpeq_epi8(chars, slash);
+
+        auto valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, is_plus));
+        if (_mm256_movemask_epi8(_mm256_or_si256(valid, is_slash)) != -1) {
+            break;
+        }
+
+        auto values = _mm256_and_si256(upper, _mm256_sub_epi8(chars, _mm256_set1_epi8('A')));
+        values = _mm256_or_si256(values, _mm256_and_si256(lower, _mm256_sub_epi8(chars, _mm256_set1_epi8('a' - 26))));
+        values = _mm256_or_si256(values, _mm256_and_si256(digit, _mm256_add_epi8(chars, _mm256_set1_epi8(52 - '0'))));
+        values = _mm256_or_si256(values, _mm256_and_si256(is_plus, _mm256_set1_epi8(62)));
+        values = _mm256_or_si256(values, _mm256_and_si256(is_slash, _mm256_set1_epi8(63)));
+
+        // 4 x 6 bits -> 24 bits in each 32 bit word, then drop the empty bytes
+        auto merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        auto bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack), compact);
+
+        auto target = output + i / 4 * 3;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(target), _mm256_castsi256_si128(bytes));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(target + 16), _mm256_extracti128_si256(bytes, 1));
+    }
+
+    return i;
+}
+
+#endif
@@ -5,6 +5,132 @@
 #include <string>
 #include <vector>
 
+#include "buffer.h"
+#include "string_view.h"
+
+enum class Base64Alphabet {
+    Standard,   // + /
+    UrlSafe,    // - _
+};
+
+/**
+ * 按分隔符惰性切分，每次返回指向原数据的token，不分配内存
+ * 单字符分隔符直接memchr，多字符分隔符memchr首字符后再比较
+ */
+class StringSplitter {
+public:
+    class Iterator {
+    public:
+        explicit Iterator(StringSplitter *splitter);
+
+        const StringView &operator*() const {
+            return token_;
+        }
+
+        const StringView *operator->() const {
+            return &token_;
+        }
+
+        Iterator &operator++();
+
+        bool operator==(const Iterator &other) const {
+            return splitter_ == other.splitter_;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return splitter_ != other.splitter_;
+        }
+
+    private:
+        StringSplitter *splitter_;
+        StringView token_;
+    };
+
+    /**
+     * skip_empty为true时跳过空token，与Strings::Split一致
+     */
+    explicit StringSplitter(StringView data, StringView delim, bool skip_empty = true);
+
+public:
+    /**
+     * 取下一个token，没有更多token时返回false
+     */
+    bool Next(StringView &token);
+
+    Iterator begin() {
+        return Iterator(this);
+    }
+
+    Iterator end() {
+        return Iterator(nullptr);
+    }
+
+private:
+    StringView data_;
+    StringView delim_;
+    bool skip_empty_;
+    bool finished_ = false;
+};
+
+/**
+ * 分块的Base64编码，不足3字节的尾部留到下一次Update，Finish时输出尾部和填充
+ */
+class Base64Encoder {
+public:
+    explicit Base64Encoder(Base64Alphabet alphabet = Base64Alphabet::Standard, bool padding = true);
+
+public:
+    /**
+     * 输入size字节时output至少需要的空间
+     */
+    static size_t GetMaxOutputSize(size_t size);
+
+    /**
+     * 编码一块数据，返回写入output的字节数
+     */
+    size_t Update(const char *data, size_t size, char *output);
+
+    size_t Update(const Buffer &buffer, char *output);
+
+    /**
+     * 输出剩余的数据，output至少需要4字节，之后可以重新开始编码
+     */
+    size_t Finish(char *output);
+
+private:
+    Base64Alphabet alphabet_;
+    bool padding_;
+    char pending_[3];
+    size_t pending_size_ = 0;
+};
+
+/**
+ * 分块的Base64解码，填充可有可无，不完整的4字符组留到下一次Update
+ * 遇到非法字符、填充之后还有数据、或Finish时剩余1个字符都返回false
+ */
+class Base64Decoder {
+public:
+    explicit Base64Decoder(Base64Alphabet alphabet = Base64Alphabet::Standard);
+
+public:
+    static size_t GetMaxOutputSize(size_t size);
+
+    bool Update(const char *data, size_t size, char *output, size_t &written);
+
+    bool Update(const Buffer &buffer, char *output, size_t &written);
+
+    /**
+     * output至少需要3字节，之后可以重新开始解码
+     */
+    bool Finish(char *output, size_t &written);
+
+private:
+    Base64Alphabet alphabet_;
+    char pending_[4];
+    size_t pending_size_ = 0;
+    bool finished_ = false;
+};
+
 class Strings {
 public:
     static std::vector<std::string> Split(const std::string &data, const std::string &delim);
@@ -13,9 +139,68 @@ public:
 
     static std::string Trim(const std::string &data, const std::function<bool(char)> &keep_character_callback);
 
+    /**
+     * 以下为返回视图的版本，结果指向原数据，调用者需要保证原数据的生命周期
+     */
+    static StringSplitter SplitView(StringView data, StringView delim, bool skip_empty = true);
+
+    static StringView TrimSpaceView(StringView data);
+
+    template<typename Predicate>
+    static StringView TrimView(StringView data, Predicate keep_character) {
+        size_t start = 0;
+        while (start < data.size() && !keep_character(data[start])) {
+            ++start;
+        }
+
+        size_t end = data.size();
+        while (end > start && !keep_character(data[end - 1])) {
+            --end;
+        }
+
+        return data.substr(start, end - start);
+    }
+
+    /**
+     * 十六进制字符串转为二进制，长度为奇数或含有非十六进制字符时返回空字符串
+     */
     static std::string Hex2Bin(const std::string &str);
 
     static std::string Bin2Hex(const std::string &data);
+
+    /**
+     * 编码为小写十六进制，output至少需要2 * size字节，返回写入的字节数
+     * 支持AVX2时每次处理32字节，否则使用SSE2，非x86平台使用查表
+     */
+    static size_t HexEncode(const char *data, size_t size, char *output);
+
+    /**
+     * 解码十六进制(大小写均可)，output至少需要size / 2字节
+     * size为奇数或含有非十六进制字符时返回false，此时output的内容不确定
+     */
+    static bool HexDecode(const char *data, size_t size, char *output);
+
+    static size_t GetBase64EncodedSize(size_t size, bool padding = true);
+
+    /**
+     * Base64编码，output至少需要GetBase64EncodedSize字节，返回写入的字节数
+     * 支持AVX2时每次处理24字节，其余使用查表
+     */
+    static size_t Base64Encode(const char *data, size_t size, char *output,
+                               Base64Alphabet alphabet = Base64Alphabet::Standard, bool padding = true);
+
+    /**
+     * Base64解码，填充可有可无，output至少需要(size + 3) / 4 * 3字节
+     * 含有非法字符(包括空白)或长度不合法时返回false
+     */
+    static bool Base64Decode(const char *data, size_t size, char *output, size_t &written,
+                             Base64Alphabet alphabet = Base64Alphabet::Standard);
+
+    static std::string Base64Encode(StringView data, Base64Alphabet alphabet = Base64Alphabet::Standard,
+                                    bool padding = true);
+
+    static bool Base64Decode(StringView data, std::string &result,
+                             Base64Alphabet alphabet = Base64Alphabet::Standard);
 };
 
 #endif //STRINGS_H
@@ -0,0 +1,98 @@
+#include <memory>
+#include <netinet/in.h>
+
+#include "gtest/gtest.h"
+
+#include "socket/endpoint.h"
+#include "socket/poll_thread.h"
+#include "socket/socket.h"
+
+TEST(TestEndpointSuite, TestParse) {
+    Endpoint endpoint;
+    EXPECT_FALSE(endpoint.IsValid());
+
+    EXPECT_TRUE(Endpoint::Parse("10.1.2.3", 80, endpoint));
+    EXPECT_TRUE(endpoint.IsValid());
+    EXPECT_EQ(endpoint.GetFamily(), AF_INET);
+    EXPECT_EQ(endpoint.GetAddressLength(), sizeof(sockaddr_in));
+
+    EXPECT_TRUE(Endpoint::Parse("fe80::1:2", 443, endpoint));
+    EXPECT_EQ(endpoint.GetFamily(), AF_INET6);
+    EXPECT_EQ(endpoint.GetAddressLength(), sizeof(sockaddr_in6));
+
+    // a failed parse leaves the endpoint unchanged
+    EXPECT_FALSE(Endpoint::Parse("1.2.3.256", 80, endpoint));
+    EXPECT_FALSE(Endpoint::Parse("[::1]", 80, endpoint));
+    EXPECT_FALSE(Endpoint::Parse("localhost", 80, endpoint));
+    EXPECT_FALSE(Endpoint::Parse("", 80, endpoint));
+    EXPECT_EQ(endpoint.GetFamily(), AF_INET6);
+    EXPECT_EQ(endpoint.GetPort(), 443);
+}
+
+TEST(TestEndpointSuite, TestToString) {
+    Endpoint v4;
+    EXPECT_TRUE(Endpoint::Parse("127.0.0.1", 8080, v4));
+    EXPECT_EQ(v4.GetIp(), "127.0.0.1");
+    EXPECT_EQ(v4.GetPort(), 8080);
+    EXPECT_EQ(v4.ToString(), "127.0.0.1:8080");
+
+    Endpoint v6;
+    EXPECT_TRUE(Endpoint::Parse("::1", 65535, v6));
+    EXPECT_EQ(v6.GetIp(), "::1");
+    EXPECT_EQ(v6.GetPort(), 65535);
+    EXPECT_EQ(v6.ToString(), "[::1]:65535");
+
+    // the ip without brackets parses back to the same address
+    Endpoint copy(v6.GetAddress(), v6.GetAddressLength());
+    Endpoint parsed;
+    EXPECT_TRUE(Endpoint::Parse(copy.GetIp(), copy.GetPort(), parsed));
+    EXPECT_EQ(parsed.ToString(), v6.ToString());
+
+    EXPECT_EQ(Endpoint().ToString(), ":0");
+}
+
+TEST(TestEndpointSuite, TestBindAnyV6) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    // the default "0.0.0.0" binds the ipv6 any address on an ipv6 socket
+    auto socket = std::make_shared<Socket>("any-v6", poll_thread);
+    ASSERT_EQ(socket->Initialize(SocketType::Udp, true, AF_INET6), Success);
+    EXPECT_EQ(socket->Bind(0), Success);
+    EXPECT_EQ(socket->GetLocalEndpoint().GetFamily(), AF_INET6);
+    EXPECT_EQ(socket->GetLocalIp(), "::");
+    EXPECT_GT(socket->GetLocalPort(), 0);
+
+    socket->Close();
+    poll_thread->Release();
+}
+
+TEST(TestEndpointSuite, TestLoopbackV6) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    auto server = std::make_shared<Socket>("server-v6", poll_thread);
+    ASSERT_EQ(server->Initialize(SocketType::TcpServer, true, AF_INET6), Success);
+    ASSERT_EQ(server->Bind(0, "::1"), Success);
+    ASSERT_EQ(server->Listen(), Success);
+    auto port = server->GetLocalPort();
+    EXPECT_EQ(server->GetLocalIp(), "::1");
+    EXPECT_GT(port, 0);
+
+    // a blocking connect completes in the kernel backlog, no accept is needed
+    auto client = std::make_shared<Socket>("client-v6", poll_thread);
+    ASSERT_EQ(client->Initialize(SocketType::TcpClient, false, AF_INET6), Success);
+    ErrorCode result = Not_Implement;
+    client->Connect("::1", port, [&result](ErrorCode error_code) {
+        result = error_code;
+    });
+    EXPECT_EQ(result, Success);
+    EXPECT_EQ(client->GetPeerIp(), "::1");
+    EXPECT_EQ(client->GetPeerPort(), port);
+    EXPECT_EQ(client->GetLocalIp(), "::1");
+    EXPECT_EQ(client->GetPeerEndpoint().ToString(), "[::1]:" + std::to_string(port));
+
+    client->Close();
+    server->Close();
+    poll_thread->Release();
+}
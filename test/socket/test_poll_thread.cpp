@@ -0,0 +1,233 @@
+#include <chrono>
+#include <future>
+#include <memory>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "socket/poll_thread.h"
+
+static constexpr auto kWaitTimeout = std::chrono::seconds(2);
+
+TEST(TestPollThreadSuite, TestRefreshDropsOwner) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(poll_thread->AddEvent(fd, Event_Readable, [](int) {}), Success);
+
+    // the owner deletes its event when destroyed, like a Socket whose last reference was the refresh callback
+    std::shared_ptr<int> owner(new int(fd), [poll_thread](int *fd) {
+        poll_thread->DelEvent(*fd);
+        delete fd;
+    });
+
+    std::promise<bool> result;
+    auto ret = poll_thread->RefreshEvent(fd, [&owner]() {
+        owner.reset();
+        return static_cast<int>(Event_Readable | Event_Writable);
+    }, [&result](bool success) {
+        result.set_value(success);
+    });
+    ASSERT_EQ(ret, Success);
+
+    auto future = result.get_future();
+    ASSERT_EQ(future.wait_for(kWaitTimeout), std::future_status::ready);
+    EXPECT_FALSE(future.get());
+    EXPECT_EQ(poll_thread->GetEventCount(), 0);
+
+    close(fd);
+    poll_thread->Release();
+}
+
+TEST(TestPollThreadSuite, TestRefreshOnPollThreadDropsOwner) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(poll_thread->AddEvent(fd, Event_Readable, [](int) {}), Success);
+
+    std::shared_ptr<int> owner(new int(fd), [poll_thread](int *fd) {
+        poll_thread->DelEvent(*fd);
+        delete fd;
+    });
+
+    std::promise<ErrorCode> result;
+    poll_thread->Async([poll_thread, fd, &owner, &result]() {
+        // applied inline on the poll thread
+        result.set_value(poll_thread->RefreshEvent(fd, [&owner]() {
+            owner.reset();
+            return static_cast<int>(Event_Readable | Event_Writable);
+        }));
+    });
+
+    auto future = result.get_future();
+    ASSERT_EQ(future.wait_for(kWaitTimeout), std::future_status::ready);
+    EXPECT_EQ(future.get(), Modify_Epoll_Event_Failed);
+    EXPECT_EQ(poll_thread->GetEventCount(), 0);
+
+    close(fd);
+    poll_thread->Release();
+}
+
+TEST(TestPollThreadSuite, TestDropLastHolderOnPollThread) {
+    auto holder = std::make_shared<PollThread>(0);
+    ASSERT_EQ(holder->Initialize(), Success);
+    std::weak_ptr<PollThread> weak_poll_thread = holder;
+
+    // the poll thread can not join itself, it is destroyed after the callback returned
+    std::promise<void> dropped;
+    auto poll_thread = holder.get();
+    poll_thread->Async([&holder, &dropped]() {
+        holder.reset();
+        dropped.set_value();
+    }, false);
+
+    ASSERT_EQ(dropped.get_future().wait_for(kWaitTimeout), std::future_status::ready);
+    auto deadline = std::chrono::steady_clock::now() + kWaitTimeout;
+    while (!weak_poll_thread.expired() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(weak_poll_thread.expired());
+}
+
+TEST(TestPollThreadSuite, TestReleaseRunsPendingTasks) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    std::promise<void> started;
+    std::promise<void> gate;
+    auto gate_future = gate.get_future().share();
+    poll_thread->Async([&started, gate_future]() {
+        started.set_value();
+        gate_future.wait();
+    });
+    ASSERT_EQ(started.get_future().wait_for(kWaitTimeout), std::future_status::ready);
+
+    // accepted before the release, the task still runs
+    bool ran = false;
+    ASSERT_EQ(poll_thread->Async([&ran]() {
+        ran = true;
+    }), Success);
+
+    std::thread releaser([poll_thread]() {
+        poll_thread->Release();
+    });
+    while (poll_thread->Async([]() {}) != Poll_Thread_Released) {
+        std::this_thread::yield();
+    }
+    gate.set_value();
+    releaser.join();
+
+    EXPECT_TRUE(ran);
+}
+
+TEST(TestPollThreadSuite, TestModifySameEventsSkipsEpoll) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(poll_thread->AddEvent(fd, Event_Readable, [](int) {}), Success);
+    // closing the only reference removes the fd from epoll, any epoll_ctl on it fails from now on
+    close(fd);
+
+    auto modify = [&poll_thread, fd](int events) {
+        std::promise<bool> result;
+        auto ret = poll_thread->ModifyEvent(fd, events, [&result](bool success) {
+            result.set_value(success);
+        });
+        EXPECT_EQ(ret, Success);
+        auto future = result.get_future();
+        EXPECT_EQ(future.wait_for(kWaitTimeout), std::future_status::ready);
+        return future.get();
+    };
+
+    EXPECT_TRUE(modify(Event_Readable));
+    EXPECT_FALSE(modify(Event_Readable | Event_Writable));
+
+    poll_thread->Release();
+}
+
+TEST(TestPollThreadSuite, TestInvalidCpus) {
+    PollThreadOptions options;
+    options.cpus = {-1};
+    auto negative = std::make_shared<PollThread>(0, options);
+    EXPECT_EQ(negative->Initialize(), Invalid_Cpu_Set);
+
+    options.cpus = {CPU_SETSIZE};
+    auto out_of_range = std::make_shared<PollThread>(1, options);
+    EXPECT_EQ(out_of_range->Initialize(), Invalid_Cpu_Set);
+
+    // a cpu the process may run on is accepted
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set), &cpu_set), 0);
+    int cpu = 0;
+    while (cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &cpu_set)) {
+        ++cpu;
+    }
+    ASSERT_LT(cpu, CPU_SETSIZE);
+    options.cpus = {cpu};
+    auto pinned = std::make_shared<PollThread>(2, options);
+    ASSERT_EQ(pinned->Initialize(), Success);
+    EXPECT_EQ(pinned->Async([]() {}), Success);
+    pinned->Release();
+}
+
+TEST(TestPollThreadSuite, TestAdaptiveBusyPollWindow) {
+    PollThreadOptions options;
+    options.busy_poll_us = 1000;
+    auto poll_thread = std::make_shared<PollThread>(0, options);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    std::atomic<int> received{0};
+    ASSERT_EQ(poll_thread->AddEvent(fd, Event_Readable, [fd, &received](int) {
+        uint64_t value;
+        if (read(fd, &value, sizeof(value)) == sizeof(value)) {
+            ++received;
+        }
+    }), Success);
+
+    auto notify = [fd]() {
+        uint64_t value = 1;
+        return write(fd, &value, sizeof(value)) == sizeof(value);
+    };
+
+    // events far apart stop the spinning
+    auto notify_sparse = [&poll_thread, &notify]() {
+        for (int i = 0; i < 10 && poll_thread->GetBusyPollWindowMicroseconds() > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            EXPECT_TRUE(notify());
+        }
+    };
+
+    // back to back events spin again, never longer than the configured limit
+    auto notify_rapid = [&poll_thread, &notify, &received]() {
+        auto deadline = std::chrono::steady_clock::now() + kWaitTimeout;
+        while (poll_thread->GetBusyPollWindowMicroseconds() == 0 && std::chrono::steady_clock::now() < deadline) {
+            auto expected = received + 1;
+            EXPECT_TRUE(notify());
+            while (received < expected && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    notify_rapid();
+    EXPECT_GT(poll_thread->GetBusyPollWindowMicroseconds(), 0);
+    notify_sparse();
+    EXPECT_EQ(poll_thread->GetBusyPollWindowMicroseconds(), 0);
+    notify_rapid();
+    EXPECT_GT(poll_thread->GetBusyPollWindowMicroseconds(), 0);
+    EXPECT_LE(poll_thread->GetBusyPollWindowMicroseconds(), 1000);
+
+    poll_thread->Release();
+    close(fd);
+}
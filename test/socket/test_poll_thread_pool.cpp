@@ -0,0 +1,346 @@
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "socket/poll_thread_pool.h"
+#include "socket/socket.h"
+#include "socket/tcp_server.h"
+#include "utils/cpu_topology.h"
+
+static constexpr auto kWaitTimeout = std::chrono::seconds(2);
+static constexpr uint16_t kElasticServerPort = 10010;
+
+static bool WaitFor(const std::function<bool()> &condition) {
+    auto deadline = std::chrono::steady_clock::now() + kWaitTimeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+static int ConnectTo(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static std::vector<std::shared_ptr<PollThread>> GetPollThreads(const PollThreadPool::Ptr &group) {
+    std::vector<std::shared_ptr<PollThread>> poll_threads;
+    for (size_t i = 0; i < group->GetSize(); ++i) {
+        poll_threads.push_back(group->GetPollThread(PollThreadSelectPolicy::RoundRobin));
+    }
+
+    return poll_threads;
+}
+
+TEST(TestPollThreadPoolSuite, TestSelectPolicies) {
+    PollThreadPoolConfig config;
+    config.pool_size = 3;
+    ASSERT_EQ(PollThreadPool::CreateGroup("select", config), Success);
+    auto group = PollThreadPool::GetGroup("select");
+    ASSERT_NE(group, nullptr);
+
+    // round robin visits every thread once before repeating
+    auto poll_threads = GetPollThreads(group);
+    ASSERT_EQ(poll_threads.size(), 3u);
+    EXPECT_NE(poll_threads[0], poll_threads[1]);
+    EXPECT_NE(poll_threads[0], poll_threads[2]);
+    EXPECT_NE(poll_threads[1], poll_threads[2]);
+    EXPECT_EQ(group->GetPollThread(PollThreadSelectPolicy::RoundRobin), poll_threads[0]);
+
+    int fds[2];
+    for (int i = 0; i < 2; ++i) {
+        fds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ASSERT_GE(fds[i], 0);
+        ASSERT_EQ(poll_threads[i]->AddEvent(fds[i], Event_Readable, [](int) {}), Success);
+    }
+    EXPECT_EQ(group->GetPollThread(PollThreadSelectPolicy::LeastConnections), poll_threads[2]);
+
+    poll_threads[0]->UpdateQueuedBytes(100);
+    poll_threads[2]->UpdateQueuedBytes(50);
+    EXPECT_EQ(group->GetPollThread(PollThreadSelectPolicy::LeastQueuedBytes), poll_threads[1]);
+    poll_threads[0]->UpdateQueuedBytes(-100);
+    poll_threads[2]->UpdateQueuedBytes(-50);
+
+    // the default policy is used without an explicit one
+    group->SetSelectPolicy(PollThreadSelectPolicy::LeastConnections);
+    EXPECT_EQ(group->GetSelectPolicy(), PollThreadSelectPolicy::LeastConnections);
+    EXPECT_EQ(group->GetPollThread(), poll_threads[2]);
+
+    for (int i = 0; i < 2; ++i) {
+        poll_threads[i]->DelEvent(fds[i]);
+        close(fds[i]);
+    }
+    PollThreadPool::ReleaseGroup("select");
+}
+
+TEST(TestPollThreadPoolSuite, TestPowerOfTwoChoices) {
+    PollThreadPoolConfig config;
+    config.pool_size = 2;
+    ASSERT_EQ(PollThreadPool::CreateGroup("two-choices", config), Success);
+    auto group = PollThreadPool::GetGroup("two-choices");
+    ASSERT_NE(group, nullptr);
+    auto poll_threads = GetPollThreads(group);
+    ASSERT_EQ(poll_threads.size(), 2u);
+
+    // with two threads both are sampled, the one with fewer events always wins
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(poll_threads[0]->AddEvent(fd, Event_Readable, [](int) {}), Success);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(group->GetPollThread(PollThreadSelectPolicy::PowerOfTwoChoices), poll_threads[1]);
+    }
+
+    // equal event counts fall back to the queued bytes
+    poll_threads[0]->DelEvent(fd);
+    poll_threads[1]->UpdateQueuedBytes(100);
+    ASSERT_TRUE(WaitFor([&poll_threads]() {
+        return poll_threads[0]->GetEventCount() == poll_threads[1]->GetEventCount();
+    }));
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(group->GetPollThread(PollThreadSelectPolicy::PowerOfTwoChoices), poll_threads[0]);
+    }
+    poll_threads[1]->UpdateQueuedBytes(-100);
+
+    close(fd);
+    PollThreadPool::ReleaseGroup("two-choices");
+}
+
+TEST(TestPollThreadPoolSuite, TestSocketAffinity) {
+    PollThreadPoolConfig config;
+    config.pool_size = 2;
+    ASSERT_EQ(PollThreadPool::CreateGroup("affinity", config), Success);
+    auto group = PollThreadPool::GetGroup("affinity");
+    ASSERT_NE(group, nullptr);
+    auto poll_threads = GetPollThreads(group);
+    ASSERT_EQ(poll_threads.size(), 2u);
+
+    auto socket = std::make_shared<Socket>("affinity", poll_threads[1]);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(group->GetPollThread(socket), poll_threads[1]);
+    }
+
+    // a draining thread is not handed out again, the default policy picks a thread of the group
+    auto draining = std::make_shared<PollThread>(100);
+    ASSERT_EQ(draining->Initialize(), Success);
+    draining->Drain([]() { return nullptr; });
+    ASSERT_TRUE(draining->IsDraining());
+    auto drained_socket = std::make_shared<Socket>("drained", draining);
+    auto selected = group->GetPollThread(drained_socket);
+    EXPECT_NE(selected, draining);
+    EXPECT_TRUE(selected == poll_threads[0] || selected == poll_threads[1]);
+
+    draining->Release();
+    PollThreadPool::ReleaseGroup("affinity");
+}
+
+TEST(TestPollThreadPoolSuite, TestNamedGroups) {
+    PollThreadPoolConfig config;
+    config.pool_size = 2;
+    config.name = "latency";
+    ASSERT_EQ(PollThreadPool::CreateGroup("latency", config), Success);
+    config.name = "bulk";
+    ASSERT_EQ(PollThreadPool::CreateGroup("bulk", config), Success);
+    EXPECT_EQ(PollThreadPool::CreateGroup("bulk", config), Already_Initialized);
+    EXPECT_EQ(PollThreadPool::GetGroup("unknown"), nullptr);
+
+    auto latency = PollThreadPool::GetGroup("latency");
+    auto bulk = PollThreadPool::GetGroup("bulk");
+    ASSERT_NE(latency, nullptr);
+    ASSERT_NE(bulk, nullptr);
+    EXPECT_EQ(latency->GetName(), "latency");
+    EXPECT_EQ(bulk->GetName(), "bulk");
+
+    // the groups never share a poll thread
+    auto latency_threads = GetPollThreads(latency);
+    auto bulk_threads = GetPollThreads(bulk);
+    ASSERT_EQ(latency_threads.size(), 2u);
+    ASSERT_EQ(bulk_threads.size(), 2u);
+    for (auto &poll_thread: latency_threads) {
+        EXPECT_NE(poll_thread, bulk_threads[0]);
+        EXPECT_NE(poll_thread, bulk_threads[1]);
+    }
+
+    // a released group keeps running for its holders, its name can be reused
+    PollThreadPool::ReleaseGroup("bulk");
+    EXPECT_EQ(PollThreadPool::GetGroup("bulk"), nullptr);
+    std::promise<void> ran;
+    ASSERT_EQ(bulk->GetPollThread()->Async([&ran]() {
+        ran.set_value();
+    }, false), Success);
+    EXPECT_EQ(ran.get_future().wait_for(kWaitTimeout), std::future_status::ready);
+    ASSERT_EQ(PollThreadPool::CreateGroup("bulk", config), Success);
+    EXPECT_NE(PollThreadPool::GetGroup("bulk"), bulk);
+
+    // the last holder stops the poll threads
+    bulk.reset();
+    for (auto &poll_thread: bulk_threads) {
+        EXPECT_EQ(poll_thread->Async([]() {}), Poll_Thread_Released);
+    }
+
+    PollThreadPool::ReleaseGroup("bulk");
+    PollThreadPool::ReleaseGroup("latency");
+}
+
+TEST(TestPollThreadPoolSuite, TestDropGroupOnPollThread) {
+    PollThreadPoolConfig config;
+    config.pool_size = 2;
+    ASSERT_EQ(PollThreadPool::CreateGroup("drop", config), Success);
+    auto group = PollThreadPool::GetGroup("drop");
+    PollThreadPool::ReleaseGroup("drop");
+    ASSERT_NE(group, nullptr);
+
+    // the last holder stops all poll threads of the group, including the current one
+    auto poll_thread = group->GetPollThread();
+    std::promise<void> dropped;
+    poll_thread->Async([&group, &dropped]() {
+        group.reset();
+        dropped.set_value();
+    }, false);
+
+    ASSERT_EQ(dropped.get_future().wait_for(kWaitTimeout), std::future_status::ready);
+    EXPECT_EQ(poll_thread->Async([]() {}), Poll_Thread_Released);
+}
+
+TEST(TestPollThreadPoolSuite, TestElasticScaleWithServer) {
+    PollThreadPoolConfig config;
+    config.max_pool_size = 2;
+    config.min_pool_size = 1;
+    config.scale_interval_ms = 20;
+    config.scale_samples = 2;
+    config.scale_up_utilization = 0.5;
+    config.scale_down_utilization = 0.1;
+    ASSERT_EQ(PollThreadPool::CreateGroup("elastic", config), Success);
+    auto group = PollThreadPool::GetGroup("elastic");
+    ASSERT_EQ(group->GetSize(), 1u);
+    auto first = group->GetPollThread();
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Socket>> sockets;
+    std::vector<std::shared_ptr<Session>> sessions;
+    std::atomic<int> received{0};
+    auto server = std::make_shared<TcpServer>("elastic-server", group);
+    server->SetSessionCreator([&mutex, &sockets, &received](const std::string &id, std::shared_ptr<Socket> &socket) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sockets.push_back(socket);
+        auto session = std::make_shared<Session>(id, socket);
+        socket->SetOnReadCallback([&received](Buffer::Ptr &buf, sockaddr *, int) {
+            received += static_cast<int>(buf->GetContentSize());
+        });
+        return session;
+    });
+    server->SetNewSessionCallback([&mutex, &sessions](std::shared_ptr<Session> &session) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sessions.push_back(session);
+    });
+    ASSERT_EQ(server->Start(kElasticServerPort, "127.0.0.1"), Success);
+
+    // keep the first thread busy, the average stays at 0.5 once the second thread was added
+    std::atomic<bool> loading{true};
+    std::function<void()> spin = [&loading, &spin, first]() {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+        if (loading) {
+            first->Async(spin, false);
+        }
+    };
+    first->Async(spin, false);
+    ASSERT_TRUE(WaitFor([&group]() { return group->GetSize() == 2; }));
+
+    std::vector<int> clients;
+    for (int i = 0; i < 4; ++i) {
+        clients.push_back(ConnectTo(kElasticServerPort));
+        ASSERT_GE(clients.back(), 0);
+    }
+    ASSERT_TRUE(WaitFor([&mutex, &sessions]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sessions.size() == 4;
+    }));
+
+    std::shared_ptr<PollThread> second;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &socket: sockets) {
+            if (socket->GetPollThread() != first) {
+                second = socket->GetPollThread();
+            }
+        }
+    }
+    ASSERT_NE(second, nullptr);
+
+    // idle again, the second thread has fewer events than the listening one and is drained
+    loading = false;
+    ASSERT_TRUE(WaitFor([&group, &second]() {
+        return group->GetSize() == 1 && second->Async([]() {}) == Poll_Thread_Released;
+    }));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &socket: sockets) {
+            EXPECT_EQ(socket->GetPollThread(), first);
+        }
+    }
+
+    // the migrated connections still receive, and new connections are accepted
+    for (auto client: clients) {
+        EXPECT_EQ(write(client, "x", 1), 1);
+    }
+    clients.push_back(ConnectTo(kElasticServerPort));
+    EXPECT_TRUE(WaitFor([&received, &mutex, &sessions]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return received == 4 && sessions.size() == 5;
+    }));
+
+    for (auto client: clients) {
+        close(client);
+    }
+    server->Stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sessions.clear();
+        sockets.clear();
+    }
+    PollThreadPool::ReleaseGroup("elastic");
+}
+
+TEST(TestPollThreadPoolSuite, TestInvalidCpuSet) {
+    auto cpus = CpuTopology::GetAvailableCpus();
+    ASSERT_FALSE(cpus.empty());
+
+    // the first thread starts, the second one fails and the whole group is not created
+    PollThreadPoolConfig config;
+    config.cpu_sets = {{cpus.front()}, {CPU_SETSIZE}};
+    EXPECT_EQ(PollThreadPool::CreateGroup("invalid-cpus", config), Invalid_Cpu_Set);
+    EXPECT_EQ(PollThreadPool::GetGroup("invalid-cpus"), nullptr);
+
+    config.cpu_sets = {{cpus.front()}};
+    ASSERT_EQ(PollThreadPool::CreateGroup("invalid-cpus", config), Success);
+    auto group = PollThreadPool::GetGroup("invalid-cpus");
+    ASSERT_NE(group, nullptr);
+    EXPECT_EQ(group->GetSize(), 1u);
+    PollThreadPool::ReleaseGroup("invalid-cpus");
+}
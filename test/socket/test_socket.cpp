@@ -0,0 +1,224 @@
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "socket/poll_thread.h"
+#include "socket/socket.h"
+#include "utils/ref_buffer.h"
+
+static constexpr auto kWaitTimeout = std::chrono::seconds(2);
+
+static bool WaitFor(const std::function<bool()> &condition) {
+    auto deadline = std::chrono::steady_clock::now() + kWaitTimeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+// returns after the changes requested before were applied by the poll thread
+static bool WaitForPollThread(const std::shared_ptr<PollThread> &poll_thread) {
+    std::promise<void> done;
+    poll_thread->Async([&done]() {
+        done.set_value();
+    }, false);
+
+    return done.get_future().wait_for(kWaitTimeout) == std::future_status::ready;
+}
+
+static bool SendDatagram(int fd, uint16_t port, const char *data, size_t size) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    return sendto(fd, data, size, 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == static_cast<ssize_t>(size);
+}
+
+TEST(TestSocketSuite, TestPauseResumeRecv) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    auto socket = std::make_shared<Socket>("receiver", poll_thread);
+    ASSERT_EQ(socket->Initialize(SocketType::Udp, true), Success);
+    ASSERT_EQ(socket->Bind(0, "127.0.0.1"), Success);
+    std::atomic<int> received{0};
+    socket->SetOnReadCallback([&received](Buffer::Ptr &, sockaddr *, int) {
+        ++received;
+    });
+    ASSERT_EQ(socket->Listen(), Success);
+    auto port = socket->GetLocalPort();
+
+    int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sender, 0);
+    ASSERT_TRUE(SendDatagram(sender, port, "1", 1));
+    ASSERT_TRUE(WaitFor([&received]() { return received == 1; }));
+
+    // the datagrams stay in the kernel buffer while paused
+    socket->EnableRecv(false);
+    EXPECT_FALSE(socket->IsRecvEnabled());
+    ASSERT_TRUE(WaitForPollThread(poll_thread));
+    ASSERT_TRUE(SendDatagram(sender, port, "2", 1));
+    ASSERT_TRUE(SendDatagram(sender, port, "3", 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(received, 1);
+
+    socket->EnableRecv(true);
+    EXPECT_TRUE(socket->IsRecvEnabled());
+    EXPECT_TRUE(WaitFor([&received]() { return received == 3; }));
+
+    close(sender);
+    socket->Close();
+    poll_thread->Release();
+}
+
+TEST(TestSocketSuite, TestSendLocalRefBufferCopies) {
+    auto poll_thread = std::make_shared<PollThread>(0);
+    ASSERT_EQ(poll_thread->Initialize(), Success);
+
+    // not registered, so the queued buffers stay in the send queue
+    auto socket = std::make_shared<Socket>("ref-sender", poll_thread);
+    ASSERT_EQ(socket->Initialize(SocketType::Udp, true), Success);
+    ASSERT_EQ(socket->Bind(0, "127.0.0.1"), Success);
+    Endpoint endpoint;
+    ASSERT_TRUE(Endpoint::Parse("127.0.0.1", socket->GetLocalPort(), endpoint));
+
+    // still held by the caller, the queue takes an atomic copy instead of sharing the local count
+    auto buf = RefBuffer::Create("local", 5, RefCountMode::Local);
+    EXPECT_EQ(socket->SendTo(buf, endpoint, false), 5);
+    EXPECT_EQ(buf->GetRefCount(), 1);
+
+    // the last reference moved in from another thread is copied as well
+    EXPECT_EQ(socket->SendTo(std::move(buf), endpoint, false), 5);
+    EXPECT_EQ(socket->GetSendBufferCount(), 2u);
+
+    socket->Close();
+    poll_thread->Release();
+}
+
+TEST(TestSocketSuite, TestMigrateUnregistered) {
+    auto source = std::make_shared<PollThread>(0);
+    ASSERT_EQ(source->Initialize(), Success);
+    auto target = std::make_shared<PollThread>(1);
+    ASSERT_EQ(target->Initialize(), Success);
+
+    auto socket = std::make_shared<Socket>("migrate-queued", source);
+    ASSERT_EQ(socket->Initialize(SocketType::Udp, true), Success);
+    ASSERT_EQ(socket->Bind(0, "127.0.0.1"), Success);
+    Endpoint endpoint;
+    ASSERT_TRUE(Endpoint::Parse("127.0.0.1", socket->GetLocalPort(), endpoint));
+    ASSERT_EQ(socket->SendTo(RefBuffer::Create("first", 5), endpoint, false), 5);
+    ASSERT_EQ(socket->SendTo(RefBuffer::Create("second", 6), endpoint, false), 6);
+    EXPECT_EQ(source->GetQueuedBytes(), 11);
+
+    std::promise<bool> result;
+    socket->MigrateTo(target, [&result](bool success) {
+        result.set_value(success);
+    });
+    auto future = result.get_future();
+    ASSERT_EQ(future.wait_for(kWaitTimeout), std::future_status::ready);
+    EXPECT_TRUE(future.get());
+
+    // the queue moves with the socket
+    EXPECT_EQ(socket->GetPollThread(), target);
+    EXPECT_EQ(socket->GetSendBufferCount(), 2u);
+    EXPECT_EQ(socket->GetQueuedBytes(), 11);
+    EXPECT_EQ(source->GetQueuedBytes(), 0);
+    EXPECT_EQ(target->GetQueuedBytes(), 11);
+
+    socket->Close();
+    source->Release();
+    target->Release();
+}
+
+TEST(TestSocketSuite, TestMigrateWhileSending) {
+    static constexpr int kDatagramCount = 1000;
+
+    std::vector<std::shared_ptr<PollThread>> poll_threads;
+    for (int i = 0; i < 2; ++i) {
+        poll_threads.push_back(std::make_shared<PollThread>(i));
+        ASSERT_EQ(poll_threads.back()->Initialize(), Success);
+    }
+
+    int receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(receiver, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(receiver, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+    socklen_t addr_len = sizeof(addr);
+    ASSERT_EQ(getsockname(receiver, reinterpret_cast<sockaddr *>(&addr), &addr_len), 0);
+    timeval timeout{1, 0};
+    ASSERT_EQ(setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)), 0);
+
+    std::atomic<int> received{0};
+    std::thread receive_thread([receiver, &received]() {
+        char data[64];
+        while (received < kDatagramCount && recv(receiver, data, sizeof(data), 0) > 0) {
+            ++received;
+        }
+    });
+
+    auto socket = std::make_shared<Socket>("migrate-sender", poll_threads[0]);
+    ASSERT_EQ(socket->Initialize(SocketType::Udp, true), Success);
+    ASSERT_EQ(socket->Bind(0, "127.0.0.1"), Success);
+    ASSERT_EQ(socket->Listen(), Success);
+    Endpoint endpoint;
+    ASSERT_TRUE(Endpoint::Parse("127.0.0.1", ntohs(addr.sin_port), endpoint));
+
+    std::atomic<bool> sending{true};
+    std::thread send_thread([&socket, &endpoint, &received, &sending]() {
+        for (int i = 0; i < kDatagramCount; ++i) {
+            // keep the loopback receive buffer from dropping datagrams, a stalled queue fails below
+            auto deadline = std::chrono::steady_clock::now() + kWaitTimeout;
+            while (i - received > 64 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            if (i - received > 64) {
+                break;
+            }
+            socket->SendTo(RefBuffer::Create("datagram", 8), endpoint);
+        }
+        sending = false;
+    });
+
+    int migrations = 0;
+    while (sending) {
+        std::promise<bool> result;
+        socket->MigrateTo(poll_threads[++migrations % 2], [&result](bool success) {
+            result.set_value(success);
+        });
+        auto future = result.get_future();
+        ASSERT_EQ(future.wait_for(kWaitTimeout), std::future_status::ready);
+        EXPECT_TRUE(future.get());
+    }
+    send_thread.join();
+    EXPECT_GT(migrations, 0);
+
+    EXPECT_TRUE(WaitFor([&received]() { return received == kDatagramCount; }));
+    receive_thread.join();
+    EXPECT_TRUE(WaitFor([&socket, &poll_threads]() {
+        return socket->GetQueuedBytes() == 0 && poll_threads[0]->GetQueuedBytes() == 0 &&
+               poll_threads[1]->GetQueuedBytes() == 0;
+    }));
+
+    close(receiver);
+    socket->Close();
+    for (auto &poll_thread: poll_threads) {
+        poll_thread->Release();
+    }
+}
@@ -1,5 +1,10 @@
 #include <semaphore.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
@@ -12,6 +17,15 @@ void TimerCallback() {
     sem_post(&sem);
 }
 
+// waits until count reaches expect or the timeout passes, returns the last seen count
+int WaitForCount(const std::atomic<int> &count, int expect, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (count.load() < expect && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return count.load();
+}
+
 TEST(TestTimerSuite, TestSetTimer) {
     sem_init(&sem, 0, 0);
 
@@ -35,3 +49,47 @@ TEST(TestTimerSuite, TestCancelTimer) {
 
     timer_manager->Cancel(timer_id);
 }
+
+TEST(TestTimerSuite, TestPeriodicTimer) {
+    auto timer_manager = TimerManager::GetInstance();
+
+    std::atomic<int> count(0);
+    auto timer_id = timer_manager->Every(5 * 1000, [&count]() {
+        count++;
+    });
+    EXPECT_GT(timer_id, 0);
+
+    EXPECT_GE(WaitForCount(count, 5, std::chrono::seconds(10)), 5);
+    timer_manager->Cancel(timer_id);
+
+    // a callback already running when Cancel returns may still finish
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto fired = count.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(count.load(), fired);
+}
+
+TEST(TestTimerSuite, TestManyTimers) {
+    auto timer_manager = TimerManager::GetInstance();
+    auto base_count = timer_manager->GetTimerCount();
+
+    // the first timer expires in 2 seconds, so all cancels below happen before any of them can fire
+    std::atomic<int> count(0);
+    std::vector<long> timer_ids;
+    for (int i = 0; i < 100000; ++i) {
+        timer_ids.push_back(timer_manager->After(2 * 1000 * 1000 + (i % 300) * 1000, [&count]() {
+            count++;
+        }));
+    }
+
+    // cancel every other timer, including the ones still waiting in the first level above the root,
+    // the higher levels and their cascades are covered by the timing wheel tests
+    for (size_t i = 0; i < timer_ids.size(); i += 2) {
+        timer_manager->Cancel(timer_ids[i]);
+    }
+
+    EXPECT_EQ(WaitForCount(count, 50000, std::chrono::seconds(30)), 50000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(count.load(), 50000);
+    EXPECT_EQ(timer_manager->GetTimerCount(), base_count);
+}
@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "timer/timing_wheel.h"
+
+static std::unique_ptr<Timer> CreateTimer(long id, uint64_t expire_tick) {
+    std::unique_ptr<Timer> timer(new Timer(id, []() {}));
+    timer->SetExpireTime(0, expire_tick);
+    return timer;
+}
+
+// advances one tick at a time, every timer must expire exactly at its tick
+static void AdvanceTo(TimingWheel &wheel, uint64_t tick, std::vector<Timer *> &expired) {
+    for (auto current = wheel.GetCurrentTick(); current <= tick; ++current) {
+        EXPECT_GE(wheel.GetNextExpireTick(), current);
+        std::vector<Timer *> expired_now;
+        wheel.Advance(current, expired_now);
+        for (auto timer: expired_now) {
+            EXPECT_EQ(timer->GetExpireTick(), current);
+            expired.push_back(timer);
+        }
+    }
+}
+
+TEST(TestTimingWheelSuite, TestUpperLevels) {
+    // not aligned to any level, so every timer crosses partially filled blocks
+    static constexpr uint64_t kStartTick = 12345;
+    TimingWheel wheel(kStartTick);
+
+    // one timer for the root and each of the 4 upper levels
+    std::vector<uint64_t> delays = {200, (1ULL << 8) + 3, (1ULL << 14) + 5, (1ULL << 20) + 7, (1ULL << 26) + 11};
+    std::vector<std::unique_ptr<Timer>> timers;
+    for (size_t i = 0; i < delays.size(); ++i) {
+        timers.push_back(CreateTimer(static_cast<long>(i), kStartTick + delays[i]));
+        wheel.Add(timers.back().get());
+    }
+    EXPECT_EQ(wheel.GetSize(), delays.size());
+
+    std::vector<Timer *> expired;
+    for (auto &timer: timers) {
+        // skip the idle ticks in one call, then step through the last ones
+        auto expire_tick = timer->GetExpireTick();
+        wheel.Advance(expire_tick - 300, expired);
+        EXPECT_TRUE(expired.empty());
+        AdvanceTo(wheel, expire_tick, expired);
+        ASSERT_EQ(expired.size(), 1u);
+        EXPECT_EQ(expired.front(), timer.get());
+        expired.clear();
+    }
+    EXPECT_EQ(wheel.GetSize(), 0u);
+    EXPECT_EQ(wheel.GetNextExpireTick(), UINT64_MAX);
+}
+
+TEST(TestTimingWheelSuite, TestCancelAcrossCascades) {
+    TimingWheel wheel(100);
+
+    // spread over several level 1 and level 0 blocks
+    std::vector<std::unique_ptr<Timer>> timers;
+    for (int i = 0; i < 64; ++i) {
+        timers.push_back(CreateTimer(i, 100 + (1ULL << 14) + static_cast<uint64_t>(i) * 997));
+        wheel.Add(timers.back().get());
+    }
+
+    // cancel a quarter before any cascade, and another quarter after the remaining ones moved down
+    for (size_t i = 0; i < timers.size(); i += 4) {
+        wheel.Remove(timers[i].get());
+    }
+    std::vector<Timer *> expired;
+    AdvanceTo(wheel, 100 + (1ULL << 14) + 16 * 997, expired);
+    for (size_t i = 2; i < timers.size(); i += 4) {
+        if (timers[i]->GetExpireTick() > wheel.GetCurrentTick()) {
+            wheel.Remove(timers[i].get());
+        }
+    }
+    // removing twice is a no-op
+    wheel.Remove(timers[0].get());
+
+    AdvanceTo(wheel, timers.back()->GetExpireTick(), expired);
+    EXPECT_EQ(wheel.GetSize(), 0u);
+
+    std::vector<bool> fired(timers.size(), false);
+    for (auto timer: expired) {
+        EXPECT_FALSE(fired[timer->GetId()]);
+        fired[timer->GetId()] = true;
+    }
+    for (size_t i = 0; i < timers.size(); ++i) {
+        bool cancelled = i % 4 == 0 || (i % 4 == 2 && i > 16);
+        EXPECT_EQ(fired[i], !cancelled) << "timer " << i;
+    }
+}
@@ -0,0 +1,383 @@
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <netinet/in.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utils/buffer_chain.h"
+#include "utils/buffer_pool.h"
+#include "utils/buffer_sock.h"
+#include "utils/memory_allocator.h"
+#include "utils/mmap_buffer.h"
+#include "utils/copy_buffer.h"
+#include "utils/ref_buffer.h"
+#include "utils/ring_buffer.h"
+#include "utils/slice_buffer.h"
+
+static std::string ToString(const Buffer::Ptr &buffer) {
+    return std::string(buffer->GetData(), buffer->GetContentSize());
+}
+
+TEST(TestBufferSuite, TestSliceBuffer) {
+    const char *text = "hello, world";
+    Buffer::Ptr buffer = std::make_shared<CopyBuffer>(text, static_cast<int>(strlen(text)));
+
+    auto slice = SliceBuffer::Create(buffer, 7, 5);
+    EXPECT_EQ(ToString(slice), "world");
+    EXPECT_TRUE(slice->IsRetainable());
+    EXPECT_EQ(slice->GetData(), buffer->GetData() + 7);
+
+    auto sub = slice->Slice(1, 100);
+    EXPECT_EQ(ToString(sub), "orld");
+    EXPECT_EQ(sub->GetParent(), buffer);
+    EXPECT_EQ(sub->GetOffset(), 8);
+
+    auto empty = SliceBuffer::Create(buffer, 100, 5);
+    EXPECT_EQ(empty->GetContentSize(), 0);
+}
+
+TEST(TestBufferSuite, TestRetainBuffer) {
+    char data[] = "message";
+    Buffer::Ptr buffer = std::make_shared<Buffer>(data, 7);
+    EXPECT_FALSE(buffer->IsRetainable());
+
+    auto slice = SliceBuffer::Create(buffer, 0, 3);
+    EXPECT_FALSE(slice->IsRetainable());
+
+    auto retained = SliceBuffer::Retain(slice);
+    EXPECT_TRUE(retained->IsRetainable());
+    EXPECT_NE(retained->GetData(), data);
+    data[0] = 'M';
+    EXPECT_EQ(ToString(retained), "mes");
+
+    EXPECT_EQ(SliceBuffer::Retain(retained), retained);
+}
+
+TEST(TestBufferSuite, TestBufferSockReference) {
+    Buffer::Ptr buffer = std::make_shared<CopyBuffer>("payload", 7);
+    Buffer::Ptr slice = SliceBuffer::Create(buffer, 3, 4);
+
+    auto retained = std::make_shared<BufferSock>(slice, nullptr, 0);
+    EXPECT_EQ(retained->GetBuffer(), slice);
+
+    // small messages and the address are stored inside the BufferSock
+    char data[] = "payload";
+    Buffer::Ptr raw = std::make_shared<Buffer>(data, 7);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(1234);
+    auto copied = std::make_shared<BufferSock>(raw, (sockaddr *) &addr, sizeof(addr));
+    data[0] = 'P';
+    EXPECT_EQ(std::string(copied->GetData(), copied->GetContentSize()), "payload");
+    EXPECT_EQ(ToString(copied->GetBuffer()), "payload");
+    EXPECT_EQ(copied->GetAddressLength(), sizeof(addr));
+    EXPECT_EQ(((sockaddr_in *) copied->GetAddress())->sin_port, htons(1234));
+
+    // the buffer handed out keeps the BufferSock alive
+    auto inline_buffer = copied->GetBuffer();
+    copied.reset();
+    EXPECT_EQ(ToString(inline_buffer), "payload");
+
+    std::string large(BufferSock::kInlineSize + 1, 'x');
+    Buffer::Ptr large_raw = std::make_shared<Buffer>(large.data(), static_cast<int>(large.size()));
+    auto large_copied = std::make_shared<BufferSock>(large_raw, nullptr, 0);
+    EXPECT_NE(large_copied->GetData(), large.data());
+    EXPECT_TRUE(large_copied->GetBuffer()->IsRetainable());
+}
+
+TEST(TestBufferSuite, TestBufferChain) {
+    auto chain = std::make_shared<BufferChain>();
+    Buffer::Ptr payload = std::make_shared<CopyBuffer>("payload", 7);
+    chain->Append(payload);
+    chain->Append("!", 1);
+    chain->Prepend("head:", 5);
+    EXPECT_EQ(chain->GetContentSize(), 13);
+    EXPECT_EQ(chain->GetSegmentCount(), 3u);
+    EXPECT_EQ(chain->GetSegment(1), payload);
+
+    char peek[8] = {0};
+    EXPECT_EQ(chain->Peek(peek, 6, 3), 6);
+    EXPECT_EQ(std::string(peek), "d:payl");
+
+    iovec iov[4];
+    EXPECT_EQ(chain->GetIovec(iov, 4, 6), 2);
+    EXPECT_EQ(iov[0].iov_len, 6u);
+    EXPECT_EQ(iov[1].iov_len, 1u);
+
+    auto snapshot = chain->Snapshot();
+    EXPECT_TRUE(snapshot->IsRetainable());
+    EXPECT_FALSE(chain->IsRetainable());
+
+    chain->Consume(7);
+    EXPECT_EQ(chain->GetContentSize(), 6);
+    EXPECT_EQ(chain->GetSegmentCount(), 2u);
+    EXPECT_EQ(ToString(chain), "yload!");
+    EXPECT_EQ(chain->GetSegmentCount(), 2u);
+    chain->Flatten();
+    EXPECT_EQ(chain->GetSegmentCount(), 1u);
+    EXPECT_EQ(ToString(chain), "yload!");
+
+    EXPECT_EQ(ToString(snapshot), "head:payload!");
+}
+
+TEST(TestBufferSuite, TestBufferChainSnapshotReadOnly) {
+    auto chain = std::make_shared<BufferChain>();
+    EXPECT_EQ(chain->Append("head:", 5), Success);
+    EXPECT_EQ(chain->Append("payload", 7), Success);
+    EXPECT_EQ(chain->Append("!", 1), Success);
+    auto snapshot = chain->Snapshot();
+
+    EXPECT_EQ(snapshot->Append("x", 1), Buffer_Read_Only);
+    EXPECT_EQ(snapshot->Prepend("x", 1), Buffer_Read_Only);
+    EXPECT_EQ(snapshot->Consume(1), Buffer_Read_Only);
+    EXPECT_EQ(snapshot->Flatten(), Buffer_Read_Only);
+    EXPECT_EQ(snapshot->Clear(), Buffer_Read_Only);
+    EXPECT_EQ(snapshot->GetContentSize(), 13);
+    EXPECT_EQ(snapshot->GetSegmentCount(), 3u);
+
+    // readers on several threads share a single merged copy
+    std::vector<const char *> data(4, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < data.size(); ++i) {
+        threads.emplace_back([&snapshot, &data, i]() {
+            data[i] = snapshot->GetData();
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    for (auto ptr: data) {
+        EXPECT_EQ(ptr, data.front());
+    }
+    EXPECT_EQ(std::string(data.front(), 13), "head:payload!");
+
+    EXPECT_EQ(chain->Clear(), Success);
+    EXPECT_EQ(ToString(snapshot), "head:payload!");
+}
+
+TEST(TestBufferSuite, TestBufferPool) {
+    auto pool = BufferPool::GetInstance();
+    EXPECT_EQ(BufferPool::GetBlockSize(1), 64u);
+    EXPECT_EQ(BufferPool::GetBlockSize(65), 128u);
+    EXPECT_EQ(BufferPool::GetBlockSize(BufferPool::kMaxPooledSize + 1), BufferPool::kMaxPooledSize + 1);
+
+    auto data = pool->Allocate(100);
+    pool->Deallocate(data, 100);
+    EXPECT_EQ(pool->Allocate(120), data);
+    pool->Deallocate(data, 120);
+
+    // buffers released by another thread come back through the central list
+    std::vector<char *> blocks;
+    for (int i = 0; i < 10000; ++i) {
+        blocks.push_back(pool->Allocate(256));
+    }
+    std::thread releaser([&blocks, pool]() {
+        for (auto block: blocks) {
+            pool->Deallocate(block, 256);
+        }
+    });
+    releaser.join();
+    EXPECT_GT(pool->GetCachedBytes(), 0u);
+
+    pool->Trim();
+    EXPECT_EQ(pool->GetCachedBytes(), 0u);
+
+    auto buffer = CopyBuffer::Create("pooled", 6);
+    EXPECT_EQ(ToString(buffer), "pooled");
+    EXPECT_EQ(buffer->GetData()[6], 0);
+}
+
+static void TestRingBuffer(bool mirrored) {
+    RingBuffer ring(4096, mirrored);
+    EXPECT_EQ(ring.IsMirrored(), mirrored);
+    auto capacity = ring.GetCapacity();
+    EXPECT_GE(capacity, 4096);
+
+    std::string expect;
+    int next = 0;
+    for (int round = 0; round < 100; ++round) {
+        // keep appending 300-byte frames and consuming 250 bytes, so the content wraps the end many times
+        std::string frame;
+        for (int i = 0; i < 300; ++i) {
+            frame.push_back(static_cast<char>('a' + next++ % 26));
+        }
+        if (ring.GetAvailableSpace() >= 300) {
+            EXPECT_EQ(ring.AppendData(frame.data(), 300), Success);
+            expect += frame;
+        }
+
+        EXPECT_EQ(std::string(ring.GetData(), ring.GetContentSize()), expect);
+        ring.ConsumeData(250);
+        expect.erase(0, 250);
+    }
+
+    // a write that fits behind the content does not move it
+    auto data = ring.GetData();
+    if (ring.GetTailSpace() >= 10) {
+        EXPECT_EQ(ring.AppendData("0123456789", 10), Success);
+        EXPECT_EQ(ring.GetData(), data);
+        expect += "0123456789";
+    }
+    EXPECT_EQ(std::string(ring.GetData(), ring.GetContentSize()), expect);
+    if (mirrored) {
+        EXPECT_EQ(ring.GetTailSpace(), ring.GetAvailableSpace());
+    }
+
+    std::string full(static_cast<size_t>(ring.GetAvailableSpace()) + 1, 'x');
+    EXPECT_EQ(ring.AppendData(full.data(), static_cast<int>(full.size())), Buffer_Not_Enough_Capacity);
+
+    ring.Reset();
+    EXPECT_EQ(ring.GetContentSize(), 0);
+    EXPECT_EQ(ring.GetAvailableSpace(), capacity);
+}
+
+TEST(TestBufferSuite, TestRingBuffer) {
+    TestRingBuffer(true);
+    TestRingBuffer(false);
+}
+
+TEST(TestBufferSuite, TestHugePageAllocator) {
+    std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode((std::istreambuf_iterator<char>(enabled)), std::istreambuf_iterator<char>());
+    if (mode.empty() || mode.find("[never]") != std::string::npos) {
+        GTEST_SKIP() << "transparent huge pages are disabled";
+    }
+
+    PageAllocatorOptions options;
+    options.huge_pages = HugePageMode::Transparent;
+    options.prefault = true;
+    PageAllocator allocator(options);
+
+    // only the alignment is checked, whether the kernel backs the range with huge pages is up to it
+    size_t size = 3 * 1024 * 1024;
+    auto data = allocator.Allocate(size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % PageAllocator::GetHugePageSize(), 0u);
+    memset(data, 1, size);
+    EXPECT_EQ(data[size - 1], 1);
+    allocator.Deallocate(data, size);
+}
+
+// writes content to a new unique temporary file, returns an empty path on failure
+static std::string WriteTempFile(const std::string &content) {
+    char path[] = "/tmp/test_buffer_XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    if (fd < 0) {
+        return "";
+    }
+
+    auto written = write(fd, content.data(), content.size());
+    close(fd);
+    EXPECT_EQ(written, static_cast<ssize_t>(content.size()));
+    if (written != static_cast<ssize_t>(content.size())) {
+        unlink(path);
+        return "";
+    }
+
+    return path;
+}
+
+TEST(TestBufferSuite, TestMmapBuffer) {
+    std::string content(10000, 'x');
+    content.replace(5000, 5, "hello");
+    auto path = WriteTempFile(content);
+    ASSERT_FALSE(path.empty());
+
+    MmapBuffer::Ptr buffer;
+    EXPECT_EQ(MmapBuffer::Create(path, buffer), Success);
+    EXPECT_EQ(ToString(buffer), content);
+    EXPECT_TRUE(buffer->IsRetainable());
+    EXPECT_TRUE(buffer->Advise(MmapAdvice::Sequential));
+
+    MmapBuffer::Ptr range;
+    EXPECT_EQ(MmapBuffer::Create(path, range, 5000, 5), Success);
+    EXPECT_EQ(ToString(range), "hello");
+
+    MmapBuffer::Ptr missing;
+    EXPECT_EQ(MmapBuffer::Create(path + ".missing", missing), File_Open_Failed);
+
+    // a sparse file whose size does not fit in int can only be mapped in ranges
+    ASSERT_EQ(truncate(path.c_str(), static_cast<off_t>(INT_MAX) + 1), 0);
+    MmapBuffer::Ptr large;
+    EXPECT_EQ(MmapBuffer::Create(path, large), File_Too_Large);
+    EXPECT_EQ(MmapBuffer::Create(path, large, 5000, 5), Success);
+    EXPECT_EQ(ToString(large), "hello");
+    unlink(path.c_str());
+}
+
+TEST(TestBufferSuite, TestMmapBufferCache) {
+    MmapBufferCache cache(2);
+    auto path_a = WriteTempFile("aaa");
+    auto path_b = WriteTempFile("bbbb");
+    auto path_c = WriteTempFile("c");
+    ASSERT_FALSE(path_a.empty() || path_b.empty() || path_c.empty());
+
+    MmapBuffer::Ptr first;
+    MmapBuffer::Ptr second;
+    EXPECT_EQ(cache.Get(path_a, first), Success);
+    EXPECT_EQ(cache.Get(path_a, second), Success);
+    EXPECT_EQ(first, second);
+
+    MmapBuffer::Ptr buffer;
+    EXPECT_EQ(cache.Get(path_b, buffer), Success);
+    EXPECT_EQ(cache.Get(path_a, buffer), Success);
+    EXPECT_EQ(cache.Get(path_c, buffer), Success);
+    EXPECT_EQ(cache.GetCount(), 2u);
+    EXPECT_EQ(cache.GetBytes(), 4u);
+
+    // a replaced file was mapped again, the old mapping keeps the old content
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto path_new = WriteTempFile("changed");
+    ASSERT_FALSE(path_new.empty());
+    EXPECT_EQ(rename(path_new.c_str(), path_a.c_str()), 0);
+    EXPECT_EQ(cache.Get(path_a, buffer), Success);
+    EXPECT_EQ(ToString(buffer), "changed");
+    EXPECT_EQ(ToString(first), "aaa");
+
+    unlink(path_a.c_str());
+    unlink(path_b.c_str());
+    unlink(path_c.c_str());
+}
+
+TEST(TestBufferSuite, TestRefBuffer) {
+    auto buffer = RefBuffer::Create("hello", 5, RefCountMode::Local);
+    EXPECT_EQ(buffer->GetRefCount(), 1);
+    EXPECT_EQ(std::string(buffer->GetData()), "hello");
+
+    auto copy = buffer;
+    EXPECT_EQ(buffer->GetRefCount(), 2);
+    auto moved = std::move(copy);
+    EXPECT_EQ(buffer->GetRefCount(), 2);
+
+    {
+        // a local buffer is copied, the shared_ptr may be dropped on another thread
+        auto shared = RefBuffer::ToShared(buffer);
+        EXPECT_EQ(buffer->GetRefCount(), 2);
+        EXPECT_NE(shared->GetData(), buffer->GetData());
+        EXPECT_EQ(ToString(shared), "hello");
+        EXPECT_TRUE(shared->IsRetainable());
+    }
+    EXPECT_EQ(buffer->GetRefCount(), 2);
+
+    // the send queue takes over the reference without copying
+    auto sock = std::make_shared<BufferSock>(std::move(moved), nullptr, 0);
+    EXPECT_EQ(sock->GetData(), buffer->GetData());
+    sock.reset();
+    EXPECT_EQ(buffer->GetRefCount(), 1);
+
+    auto atomic = RefBuffer::Create("world", 5);
+    {
+        auto shared = RefBuffer::ToShared(atomic);
+        EXPECT_EQ(atomic->GetRefCount(), 2);
+        EXPECT_EQ(shared->GetData(), atomic->GetData());
+    }
+    EXPECT_EQ(atomic->GetRefCount(), 1);
+}
@@ -0,0 +1,149 @@
+#include <climits>
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "utils/byte_reader.h"
+#include "utils/byte_writer.h"
+#include "utils/mutable_buffer.h"
+
+TEST(TestBytesSuite, TestRoundTrip) {
+    MutableBuffer buffer(4);
+    ByteWriter writer(buffer);
+
+    writer.WriteUint8(0x12);
+    writer.WriteUint16(0x3456);
+    writer.WriteLittle<uint32_t>(0x789abcdeu);
+    writer.WriteUint64(0x0102030405060708ull);
+    writer.WriteVarint(300);
+    writer.WriteSignedVarint(-3);
+    writer.WriteString<uint16_t>("hello");
+    writer.WriteVarintString("world");
+
+    auto length_offset = writer.Reserve(sizeof(uint32_t));
+    writer.WriteBytes("payload");
+    writer.PatchBig<uint32_t>(length_offset, static_cast<uint32_t>(writer.GetOffset() - length_offset - 4));
+
+    EXPECT_EQ(std::string(buffer.GetData(), 3), std::string("\x12\x34\x56", 3));
+
+    ByteReader reader(buffer);
+    uint8_t u8 = 0;
+    uint16_t u16 = 0;
+    uint32_t u32 = 0;
+    uint64_t u64 = 0;
+    int64_t i64 = 0;
+    StringView view;
+
+    EXPECT_TRUE(reader.ReadUint8(u8));
+    EXPECT_EQ(u8, 0x12);
+    EXPECT_TRUE(reader.ReadUint16(u16));
+    EXPECT_EQ(u16, 0x3456);
+    EXPECT_TRUE(reader.ReadLittle(u32));
+    EXPECT_EQ(u32, 0x789abcdeu);
+    EXPECT_TRUE(reader.ReadUint64(u64));
+    EXPECT_EQ(u64, 0x0102030405060708ull);
+    EXPECT_TRUE(reader.ReadVarint(u64));
+    EXPECT_EQ(u64, 300u);
+    EXPECT_TRUE(reader.ReadSignedVarint(i64));
+    EXPECT_EQ(i64, -3);
+    EXPECT_TRUE(reader.ReadString<uint16_t>(view));
+    EXPECT_TRUE(view == "hello");
+    EXPECT_TRUE(reader.ReadVarintString(view));
+    EXPECT_TRUE(view == "world");
+
+    EXPECT_TRUE(reader.ReadUint32(u32));
+    EXPECT_EQ(u32, 7u);
+    EXPECT_TRUE(reader.Require(u32));
+    EXPECT_TRUE(reader.ReadBytes(u32, view));
+    EXPECT_TRUE(view == "payload");
+    EXPECT_EQ(reader.GetRemaining(), 0u);
+}
+
+TEST(TestBytesSuite, TestSigned) {
+    MutableBuffer buffer(32);
+    ByteWriter writer(buffer);
+
+    writer.WriteBig<int8_t>(-1);
+    writer.WriteBig<int16_t>(-2);
+    writer.WriteLittle<int32_t>(-100000);
+    writer.WriteBig<int64_t>(INT64_MIN + 1);
+
+    EXPECT_EQ(std::string(buffer.GetData(), 3), std::string("\xff\xff\xfe", 3));
+
+    ByteReader reader(buffer);
+    int8_t i8 = 0;
+    int16_t i16 = 0;
+    int32_t i32 = 0;
+    int64_t i64 = 0;
+    EXPECT_TRUE(reader.ReadBig(i8));
+    EXPECT_EQ(i8, -1);
+    EXPECT_TRUE(reader.ReadBig(i16));
+    EXPECT_EQ(i16, -2);
+    EXPECT_TRUE(reader.ReadLittle(i32));
+    EXPECT_EQ(i32, -100000);
+    EXPECT_TRUE(reader.ReadBig(i64));
+    EXPECT_EQ(i64, INT64_MIN + 1);
+    EXPECT_EQ(reader.GetRemaining(), 0u);
+}
+
+TEST(TestBytesSuite, TestOutOfBounds) {
+    const char data[] = {0x01, 0x02, 0x03, static_cast<char>(0x80)};
+
+    ByteReader reader(data, 3);
+    uint32_t u32 = 0;
+    uint16_t u16 = 0;
+    EXPECT_FALSE(reader.ReadUint32(u32));
+    EXPECT_FALSE(reader.IsValid());
+    // sticky: later reads fail even if they would fit
+    EXPECT_FALSE(reader.ReadUint16(u16));
+
+    ByteReader truncated(data + 3, 1);
+    uint64_t u64 = 0;
+    EXPECT_FALSE(truncated.ReadVarint(u64));
+
+    ByteReader prefixed(data + 2, 2);
+    StringView view;
+    EXPECT_FALSE(prefixed.ReadString<uint8_t>(view));
+}
+
+TEST(TestBytesSuite, TestVarintOverflow) {
+    MutableBuffer buffer(16);
+    ByteWriter writer(buffer);
+    writer.WriteVarint(UINT64_MAX);
+    EXPECT_EQ(writer.GetOffset(), 10u);
+
+    uint64_t value = 0;
+    ByteReader max_reader(buffer);
+    EXPECT_TRUE(max_reader.ReadVarint(value));
+    EXPECT_EQ(value, UINT64_MAX);
+
+    // the 10th byte may only carry the highest bit
+    std::string overflow(9, '\xff');
+    overflow.push_back('\x02');
+    ByteReader overflow_reader(overflow.data(), overflow.size());
+    EXPECT_FALSE(overflow_reader.ReadVarint(value));
+    EXPECT_FALSE(overflow_reader.IsValid());
+}
+
+TEST(TestBytesSuite, TestWriteTooLarge) {
+    MutableBuffer buffer(16);
+    ByteWriter writer(buffer);
+    writer.WriteUint32(1);
+    EXPECT_TRUE(writer.IsValid());
+
+    // rejected before the data is read, the content is kept and later writes are ignored
+    char data = 0;
+    writer.WriteBytes(&data, static_cast<size_t>(INT_MAX) + 1);
+    EXPECT_FALSE(writer.IsValid());
+    EXPECT_EQ(writer.GetOffset(), 4u);
+    writer.WriteUint32(2);
+    writer.WriteVarint(3);
+    EXPECT_EQ(writer.Reserve(4), 4u);
+    EXPECT_EQ(writer.GetOffset(), 4u);
+    EXPECT_FALSE(writer.Ensure(1));
+
+    ByteWriter overflow_writer(buffer);
+    EXPECT_FALSE(overflow_writer.Ensure(SIZE_MAX));
+    EXPECT_FALSE(overflow_writer.IsValid());
+}
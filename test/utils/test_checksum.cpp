@@ -0,0 +1,44 @@
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "utils/checksum.h"
+
+TEST(TestChecksumSuite, TestCrc32c) {
+    EXPECT_EQ(Checksum::Crc32c("123456789"), 0xE3069283u);
+    EXPECT_EQ(Checksum::Crc32c(""), 0u);
+
+    // long enough for the interleaved streams, and an unaligned start
+    std::string data(3 * 8192 * 2 + 3 * 256 + 1000, '\0');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i * 2654435761u >> 13);
+    }
+
+    for (size_t start: {0u, 1u, 5u}) {
+        StringView view(data.data() + start, data.size() - start);
+        auto whole = Checksum::Crc32c(view);
+
+        uint32_t crc = 0;
+        for (size_t offset = 0; offset < view.size(); offset += 13) {
+            crc = Checksum::Crc32c(view.substr(offset, 13), crc);
+        }
+        EXPECT_EQ(crc, whole);
+    }
+}
+
+TEST(TestChecksumSuite, TestHash64) {
+    EXPECT_EQ(Checksum::Hash64("hello"), Checksum::Hash64(std::string("hello")));
+    EXPECT_NE(Checksum::Hash64("hello"), Checksum::Hash64("hello", 1));
+    EXPECT_NE(Checksum::Hash64(""), Checksum::Hash64(StringView("\0", 1)));
+
+    // every length class, no collisions expected
+    std::set<uint64_t> hashes;
+    std::string key;
+    for (int i = 0; i < 10000; ++i) {
+        key.assign(static_cast<size_t>(i % 100), 'k');
+        key += std::to_string(i);
+        hashes.insert(Checksum::Hash64(key));
+    }
+    EXPECT_EQ(hashes.size(), 10000u);
+}
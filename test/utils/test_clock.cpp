@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utils/clock.h"
+
+static constexpr int64_t kNanosecondsPerMillisecond = 1000000;
+
+TEST(TestClockSuite, TestSources) {
+    EXPECT_EQ(Clock::GetSource(), ClockSource::Monotonic);
+    EXPECT_LT(std::abs(Clock::Now() - Clock::GetMonotonicNanoseconds()), kNanosecondsPerMillisecond);
+
+    // a jiffy behind at most
+    EXPECT_TRUE(Clock::SetSource(ClockSource::MonotonicCoarse));
+    EXPECT_EQ(Clock::GetSource(), ClockSource::MonotonicCoarse);
+    EXPECT_LT(std::abs(Clock::Now() - Clock::GetMonotonicNanoseconds()), 20 * kNanosecondsPerMillisecond);
+
+    EXPECT_TRUE(Clock::SetSource(ClockSource::Monotonic));
+}
+
+TEST(TestClockSuite, TestTsc) {
+    if (!Clock::SetSource(ClockSource::Tsc)) {
+        // keeps the previous source when the tsc was not usable
+        EXPECT_EQ(Clock::GetSource(), ClockSource::Monotonic);
+        return;
+    }
+    EXPECT_EQ(Clock::GetSource(), ClockSource::Tsc);
+
+    // never goes backwards on any thread, and stays close to CLOCK_MONOTONIC across recalibrations
+    std::vector<std::thread> threads;
+    std::vector<int64_t> max_offsets(4, 0);
+    std::vector<bool> monotonic(4, true);
+    for (size_t i = 0; i < max_offsets.size(); ++i) {
+        threads.emplace_back([i, &max_offsets, &monotonic]() {
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+            auto last = Clock::Now();
+            while (std::chrono::steady_clock::now() < end) {
+                // bracketed by two monotonic reads, so a preemption does not count as an offset
+                auto before = Clock::GetMonotonicNanoseconds();
+                auto now = Clock::Now();
+                auto after = Clock::GetMonotonicNanoseconds();
+                if (now < last) {
+                    monotonic[i] = false;
+                }
+                last = now;
+                auto offset = now < before ? before - now : (now > after ? now - after : 0);
+                max_offsets[i] = std::max(max_offsets[i], offset);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < max_offsets.size(); ++i) {
+        EXPECT_TRUE(monotonic[i]);
+        EXPECT_LT(max_offsets[i], kNanosecondsPerMillisecond);
+    }
+
+    EXPECT_TRUE(Clock::SetSource(ClockSource::Monotonic));
+}
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utils/strings.h"
+
+static std::string MakeBinary(size_t size) {
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(i * 131 + 7);
+    }
+    return data;
+}
+
+TEST(TestStringsSuite, TestHex) {
+    EXPECT_EQ(Strings::Bin2Hex(std::string("\x00\x7f\x80\xff", 4)), "007f80ff");
+    EXPECT_EQ(Strings::Hex2Bin("007F80ff"), std::string("\x00\x7f\x80\xff", 4));
+    EXPECT_EQ(Strings::Hex2Bin("abc"), "");
+    EXPECT_EQ(Strings::Hex2Bin("zz"), "");
+
+    // cover the vector loops and their tails
+    for (size_t size: {0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 64u, 100u, 1000u}) {
+        auto data = MakeBinary(size);
+        auto hex = Strings::Bin2Hex(data);
+
+        std::string expected;
+        char temp[3];
+        for (unsigned char c: data) {
+            snprintf(temp, sizeof(temp), "%02x", c);
+            expected += temp;
+        }
+        EXPECT_EQ(hex, expected);
+        EXPECT_EQ(Strings::Hex2Bin(hex), data);
+
+        if (!hex.empty()) {
+            hex[hex.size() / 2] = 'g';
+            EXPECT_EQ(Strings::Hex2Bin(hex), "");
+        }
+    }
+}
+
+TEST(TestStringsSuite, TestSplitView) {
+    std::vector<std::string> tokens;
+    for (auto &token: Strings::SplitView("a,b,,c,", ",")) {
+        tokens.push_back(token.ToString());
+    }
+    EXPECT_EQ(tokens, Strings::Split("a,b,,c,", ","));
+
+    StringSplitter lines("GET / HTTP/1.1\r\nHost: a\r\n\r\n", "\r\n", false);
+    StringView line;
+    EXPECT_TRUE(lines.Next(line));
+    EXPECT_TRUE(line == "GET / HTTP/1.1");
+    EXPECT_TRUE(lines.Next(line));
+    EXPECT_TRUE(line == "Host: a");
+    EXPECT_TRUE(lines.Next(line));
+    EXPECT_TRUE(line.empty());
+    EXPECT_TRUE(lines.Next(line));
+    EXPECT_TRUE(line.empty());
+    EXPECT_FALSE(lines.Next(line));
+
+    EXPECT_TRUE(StringView("abcabd").find("abd") == 3);
+    EXPECT_TRUE(StringView("abcab").find("abd") == StringView::npos);
+}
+
+TEST(TestStringsSuite, TestTrimView) {
+    EXPECT_TRUE(Strings::TrimSpaceView(" \t a b \r\n") == "a b");
+    EXPECT_TRUE(Strings::TrimSpaceView(" x ") == "x");
+    EXPECT_TRUE(Strings::TrimSpaceView("   ").empty());
+    EXPECT_TRUE(Strings::TrimView("--v--", [](char c) { return c != '-'; }) == "v");
+}
+
+TEST(TestStringsSuite, TestBase64) {
+    EXPECT_EQ(Strings::Base64Encode("foob"), "Zm9vYg==");
+    EXPECT_EQ(Strings::Base64Encode("fooba", Base64Alphabet::Standard, false), "Zm9vYmE");
+    EXPECT_EQ(Strings::Base64Encode(std::string("\xfb\xff", 2), Base64Alphabet::UrlSafe), "-_8=");
+
+    std::string decoded;
+    EXPECT_TRUE(Strings::Base64Decode("Zm9vYmE=", decoded));
+    EXPECT_EQ(decoded, "fooba");
+    EXPECT_TRUE(Strings::Base64Decode("Zm9vYmE", decoded));
+    EXPECT_EQ(decoded, "fooba");
+    EXPECT_FALSE(Strings::Base64Decode("Zm9vY", decoded));
+    EXPECT_FALSE(Strings::Base64Decode("Zm=vYmE=", decoded));
+    EXPECT_FALSE(Strings::Base64Decode("-_8=", decoded));
+
+    for (size_t size: {0u, 1u, 2u, 3u, 23u, 24u, 28u, 29u, 100u, 1000u}) {
+        auto data = MakeBinary(size);
+        for (auto alphabet: {Base64Alphabet::Standard, Base64Alphabet::UrlSafe}) {
+            auto encoded = Strings::Base64Encode(data, alphabet);
+            EXPECT_EQ(encoded.size(), Strings::GetBase64EncodedSize(size));
+            EXPECT_TRUE(Strings::Base64Decode(encoded, decoded, alphabet));
+            EXPECT_EQ(decoded, data);
+
+            if (encoded.size() > 8) {
+                encoded[encoded.size() / 2] = '*';
+                EXPECT_FALSE(Strings::Base64Decode(encoded, decoded, alphabet));
+            }
+        }
+    }
+}
+
+TEST(TestStringsSuite, TestBase64Stream) {
+    auto data = MakeBinary(1000);
+    auto expected = Strings::Base64Encode(data);
+
+    // odd chunk sizes so groups straddle the chunks
+    Base64Encoder encoder;
+    std::string encoded;
+    char output[1024];
+    for (size_t offset = 0; offset < data.size(); offset += 7) {
+        Buffer chunk(data.data() + offset, static_cast<int>(std::min<size_t>(7, data.size() - offset)));
+        encoded.append(output, encoder.Update(chunk, output));
+    }
+    encoded.append(output, encoder.Finish(output));
+    EXPECT_EQ(encoded, expected);
+
+    Base64Decoder decoder;
+    std::string decoded;
+    size_t written;
+    for (size_t offset = 0; offset < encoded.size(); offset += 5) {
+        auto size = std::min<size_t>(5, encoded.size() - offset);
+        EXPECT_TRUE(decoder.Update(encoded.data() + offset, size, output, written));
+        decoded.append(output, written);
+    }
+    EXPECT_TRUE(decoder.Finish(output, written));
+    decoded.append(output, written);
+    EXPECT_EQ(decoded, data);
+
+    EXPECT_TRUE(decoder.Update("QQ==", 4, output, written));
+    EXPECT_FALSE(decoder.Update("QQ", 2, output, written));
+}